@@ -36,6 +36,18 @@ ifeq (${ENABLE_PMF}, 1)
 BL31_SOURCES		+=	lib/pmf/pmf_main.c
 endif
 
+ifeq (${ENABLE_INTR_TRACE}, 1)
+BL31_SOURCES		+=	bl31/intr_trace.c
+endif
+
+ifeq (${ENABLE_LOCK_STATS}, 1)
+BL31_SOURCES		+=	lib/locks/stat/lock_stat.c
+endif
+
+ifeq (${ENABLE_SMC_BENCH}, 1)
+BL31_SOURCES		+=	services/smc_bench/smc_bench_svc.c
+endif
+
 ifeq (${EL3_EXCEPTION_HANDLING},1)
 BL31_SOURCES		+=	bl31/ehf.c
 endif
@@ -88,3 +100,20 @@ $(eval $(call assert_boolean,SDEI_SUPPORT))
 $(eval $(call add_define,CRASH_REPORTING))
 $(eval $(call add_define,EL3_EXCEPTION_HANDLING))
 $(eval $(call add_define,SDEI_SUPPORT))
+
+# Report of the layout of the per-cpu data, extracted from the assembly of
+# lib/el3_runtime/cpu_data_layout.c built with the BL31 flags. It lists the
+# offset, size and cache line of each member of cpu_data_t.
+ifndef BL31
+CPU_DATA_LAYOUT		:=	${BUILD_PLAT}/bl31/cpu_data_layout.txt
+
+bl31: ${CPU_DATA_LAYOUT}
+
+${CPU_DATA_LAYOUT}: lib/el3_runtime/cpu_data_layout.c $(filter-out %.d,$(MAKEFILE_LIST)) | bl31_dirs
+	${ECHO} "  GEN     $@"
+	${Q}${CC} ${TF_CFLAGS} ${CFLAGS} -DIMAGE_BL31 -S $< -o $@.s
+	${Q}(echo "member offset size line";				\
+	  sed -n 's/^.*"->\(.*\)".*$$/\1/p' $@.s | tr -d '#$$') |		\
+		awk '{ printf "%-24s %8s %8s %6s\n", $$1, $$2, $$3, $$4 }' > $@
+	${Q}rm -f $@.s
+endif
@@ -16,6 +16,7 @@
 #include <ehf.h>
 #include <gic_common.h>
 #include <interrupt_mgmt.h>
+#include <intr_trace.h>
 #include <platform.h>
 #include <pubsub_events.h>
 #include <stdbool.h>
@@ -443,6 +444,7 @@ static uint64_t ehf_el3_interrupt_handler(uint32_t id, uint32_t flags,
 	 * Call registered handler. Pass the raw interrupt value to registered
 	 * handlers.
 	 */
+	intr_trace_dispatch(intr);
 	ret = handler(intr_raw, flags, handle, cookie);
 
 	return (uint64_t) ret;
@@ -0,0 +1,191 @@
+/*
+ * Copyright (c) 2018, ARM Limited and Contributors. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <arch.h>
+#include <arch_helpers.h>
+#include <errno.h>
+#include <interrupt_mgmt.h>
+#include <intr_trace.h>
+#include <platform.h>
+#include <platform_def.h>
+#include <spinlock.h>
+#include <stdbool.h>
+#include <string.h>
+
+/*
+ * Each CPU records the handling of the interrupts it takes to EL3 in a ring of
+ * its own. Interrupts do not nest in EL3, so a CPU has at most one record in
+ * progress, which is added to the ring on the way out of EL3.
+ *
+ * The CPU is the only writer of the ring: it writes a record and then advances
+ * `head`. Readers, on any CPU and serialised by intr_trace_lock, read the
+ * oldest record and then advance `tail`. Records are dropped, and counted in
+ * `lost`, while the ring is full. `tail` is in a cache line of its own so that
+ * draining does not steal the line the CPU updates on each interrupt.
+ */
+typedef struct intr_trace_cpu {
+	intr_trace_rec_t recs[INTR_TRACE_RING_SIZE];
+	intr_trace_rec_t cur;	/* Record in progress */
+	bool open;		/* cur is in progress */
+	volatile uint64_t head;
+	uint64_t lost;
+	volatile uint64_t tail __aligned(CACHE_WRITEBACK_GRANULE);
+} __aligned(CACHE_WRITEBACK_GRANULE) intr_trace_cpu_t;
+
+static intr_trace_cpu_t intr_trace_cpus[PLATFORM_CORE_COUNT];
+
+static spinlock_t intr_trace_lock;
+
+static inline intr_trace_cpu_t *intr_trace_my_cpu(void)
+{
+	return &intr_trace_cpus[plat_my_core_pos()];
+}
+
+/*
+ * Start the record of an interrupt exception. Called from the EL3 exception
+ * vectors, with the time of entry, in place of
+ * plat_ic_get_pending_interrupt_type(), whose result it returns.
+ */
+uint32_t intr_trace_begin(uint64_t entry)
+{
+	uint32_t type = plat_ic_get_pending_interrupt_type();
+	intr_trace_cpu_t *cpu = intr_trace_my_cpu();
+
+	(void)memset(&cpu->cur, 0, sizeof(cpu->cur));
+	cpu->cur.intr_id = INTR_ID_UNAVAILABLE;
+	cpu->cur.type = (uint16_t)type;
+	cpu->cur.ns = ((read_scr_el3() & SCR_NS_BIT) != 0U) ? 1U : 0U;
+	cpu->cur.entry = entry;
+	cpu->open = true;
+
+	return type;
+}
+
+/*
+ * Record the acknowledgement of an interrupt. Only the first one of an
+ * exception is recorded; interrupts acknowledged outside of an interrupt
+ * exception, e.g. by polling from an SMC handler, are ignored.
+ */
+void intr_trace_ack(uint32_t intr_raw)
+{
+	uint64_t now = read_cntpct_el0();
+	intr_trace_cpu_t *cpu = intr_trace_my_cpu();
+
+	if (!cpu->open || (cpu->cur.ack != 0U))
+		return;
+
+	cpu->cur.ack = now;
+	cpu->cur.intr_id = plat_ic_get_interrupt_id(intr_raw);
+}
+
+/*
+ * Record the call of the handler of an interrupt. The exception vectors record
+ * the call of the handler of the interrupt type; dispatchers that know the
+ * INTID, e.g. EHF, then record the call of its handler over it.
+ */
+void intr_trace_dispatch(uint32_t intr_id)
+{
+	uint64_t now = read_cntpct_el0();
+	intr_trace_cpu_t *cpu = intr_trace_my_cpu();
+
+	if (!cpu->open)
+		return;
+
+	cpu->cur.dispatch = now;
+	if (intr_id != INTR_ID_UNAVAILABLE)
+		cpu->cur.intr_id = intr_id;
+}
+
+/*
+ * Called from the EL3 exception vectors in place of
+ * get_interrupt_type_handler(), to record the call of the returned handler.
+ */
+interrupt_type_handler_t intr_trace_get_handler(uint32_t type)
+{
+	interrupt_type_handler_t handler = get_interrupt_type_handler(type);
+
+	if (handler != NULL)
+		intr_trace_dispatch(INTR_ID_UNAVAILABLE);
+
+	return handler;
+}
+
+/* Record the end of the first interrupt of an exception */
+void intr_trace_eoi(void)
+{
+	uint64_t now = read_cntpct_el0();
+	intr_trace_cpu_t *cpu = intr_trace_my_cpu();
+
+	if (!cpu->open || (cpu->cur.eoi != 0U))
+		return;
+
+	cpu->cur.eoi = now;
+}
+
+/*
+ * Complete the record of an interrupt exception and add it to the ring.
+ * Called from the EL3 exception vectors just before the return to the lower EL.
+ */
+void intr_trace_end(void)
+{
+	uint64_t now = read_cntpct_el0();
+	intr_trace_cpu_t *cpu = intr_trace_my_cpu();
+	uint64_t head = cpu->head;
+
+	if (!cpu->open)
+		return;
+
+	cpu->open = false;
+	cpu->cur.exit = now;
+
+	if ((head - cpu->tail) >= INTR_TRACE_RING_SIZE) {
+		cpu->lost++;
+		return;
+	}
+
+	cpu->recs[head & (INTR_TRACE_RING_SIZE - 1U)] = cpu->cur;
+
+	/* Publish the record before the new head */
+	dmbish();
+	cpu->head = head + 1U;
+}
+
+/*
+ * Remove the oldest record from the ring of a CPU. Also return the number of
+ * records the CPU dropped as its ring was full.
+ */
+int intr_trace_drain(unsigned int cpu_idx, intr_trace_rec_t *rec,
+		     uint64_t *lost)
+{
+	intr_trace_cpu_t *cpu;
+	uint64_t tail;
+	int rc = 0;
+
+	if (cpu_idx >= PLATFORM_CORE_COUNT)
+		return -EINVAL;
+
+	cpu = &intr_trace_cpus[cpu_idx];
+
+	spin_lock(&intr_trace_lock);
+
+	tail = cpu->tail;
+	if (tail == cpu->head) {
+		rc = -ENOENT;
+	} else {
+		/* Read the record after the head that published it */
+		dmbish();
+		*rec = cpu->recs[tail & (INTR_TRACE_RING_SIZE - 1U)];
+
+		/* Read the record before freeing its slot */
+		dmbish();
+		cpu->tail = tail + 1U;
+	}
+	*lost = cpu->lost;
+
+	spin_unlock(&intr_trace_lock);
+
+	return rc;
+}
@@ -0,0 +1,58 @@
+/*
+ * Copyright (c) 2018, ARM Limited and Contributors. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <debug.h>
+#include <intr_trace.h>
+#include <smccc_helpers.h>
+
+/*
+ * This function is responsible for handling all EL3 interrupt trace SMC calls.
+ */
+uintptr_t intr_trace_smc_handler(unsigned int smc_fid,
+			u_register_t x1,
+			u_register_t x2,
+			u_register_t x3,
+			u_register_t x4,
+			void *cookie,
+			void *handle,
+			u_register_t flags)
+{
+	int rc;
+	intr_trace_rec_t rec;
+	uint64_t lost = 0U;
+
+	switch (smc_fid) {
+	case INTR_TRACE_SMC_DRAIN:
+		/*
+		 * Remove the oldest record from the ring of one CPU and return
+		 * it to the caller.
+		 * x1 --> CPU index.
+		 * x0 --> error code, -ENOENT once the ring is empty.
+		 * x1 --> INTID in bits[31:0], interrupt type in bits[47:32],
+		 * 1 in bit[48] if the normal world was interrupted.
+		 * x2 - x6 --> times of entry, acknowledge, dispatch, end of
+		 * interrupt and exit, in counter ticks.
+		 * x7 --> number of records lost as the ring was full, also
+		 * returned with -ENOENT.
+		 */
+		rc = intr_trace_drain((unsigned int)x1, &rec, &lost);
+		if (rc != 0)
+			SMC_RET8(handle, rc, 0, 0, 0, 0, 0, 0, lost);
+
+		SMC_RET8(handle, rc,
+			 (u_register_t)rec.intr_id |
+			 ((u_register_t)rec.type << 32) |
+			 ((u_register_t)rec.ns << 48),
+			 rec.entry, rec.ack, rec.dispatch, rec.eoi, rec.exit,
+			 lost);
+
+	default:
+		break;
+	}
+
+	WARN("Unimplemented EL3 interrupt trace Call: 0x%x \n", smc_fid);
+	SMC_RET1(handle, SMC_UNK);
+}
@@ -11,6 +11,7 @@
 #include <bl_common.h>
 #include <debug.h>
 #include <errno.h>
+#include <image_decompress.h>
 #include <io_storage.h>
 #include <platform.h>
 #include <string.h>
@@ -134,15 +135,107 @@ size_t get_image_size(unsigned int image_id)
 	io_result = io_close(image_handle);
 	/* Ignore improbable/unrecoverable error in 'close' */
 
-	/* TODO: Consider maintaining open device connection from this
-	 * bootloader stage
-	 */
-	io_result = io_dev_close(dev_handle);
-	/* Ignore improbable/unrecoverable error in 'dev_close' */
+	/* Keep the device connection with FIP_TOC_CACHE, as in load_image() */
+	if ((FIP_TOC_CACHE == 0) || (image_size == 0U)) {
+		io_result = io_dev_close(dev_handle);
+		/* Ignore improbable/unrecoverable error in 'dev_close' */
+	}
 
 	return image_size;
 }
 
+#if TRUSTED_BOARD_BOOT && AUTH_STREAM_HASH
+/*******************************************************************************
+ * Internal function to read an image in chunks with asynchronous reads, so
+ * that each chunk is hashed while the next one is being read. Returns -ENOTSUP
+ * without reading anything if the device does not support asynchronous reads.
+ ******************************************************************************/
+static int read_image_async(uintptr_t image_handle, uintptr_t image_base,
+			    size_t image_size, size_t *bytes_read)
+{
+	uintptr_t chunk_base;
+	size_t chunk_size;
+	size_t chunk_read;
+	int io_result;
+
+	*bytes_read = 0U;
+	chunk_size = MIN(image_size, (size_t)AUTH_STREAM_HASH_CHUNK_SIZE);
+	io_result = io_read_submit(image_handle, image_base, chunk_size);
+
+	while (io_result == 0) {
+		do {
+			io_result = io_read_poll(image_handle, &chunk_read);
+		} while (io_result == -EBUSY);
+
+		if ((io_result != 0) || (chunk_read == 0U)) {
+			break;
+		}
+
+		chunk_base = image_base + *bytes_read;
+		*bytes_read += chunk_read;
+		if (*bytes_read == image_size) {
+			auth_mod_hash_update((void *)chunk_base, chunk_read);
+			break;
+		}
+
+		/* Start to read the next chunk before hashing this one */
+		chunk_size = MIN(image_size - *bytes_read,
+				 (size_t)AUTH_STREAM_HASH_CHUNK_SIZE);
+		io_result = io_read_submit(image_handle,
+					   image_base + *bytes_read,
+					   chunk_size);
+
+		auth_mod_hash_update((void *)chunk_base, chunk_read);
+	}
+
+	return io_result;
+}
+#endif /* TRUSTED_BOARD_BOOT && AUTH_STREAM_HASH */
+
+/*******************************************************************************
+ * Internal function to read an image into memory. If the image is hashed as it
+ * is loaded (see auth_mod_hash_start()), it is read in chunks which are passed
+ * to the authentication module while they are still in the data cache, and
+ * with asynchronous reads if the device supports them.
+ ******************************************************************************/
+static int read_image(uintptr_t image_handle, uintptr_t image_base,
+		      size_t image_size, size_t *bytes_read, int hash_stream)
+{
+#if TRUSTED_BOARD_BOOT && AUTH_STREAM_HASH
+	size_t chunk_size;
+	size_t chunk_read;
+	int io_result;
+
+	if (hash_stream != 0) {
+		io_result = read_image_async(image_handle, image_base,
+					     image_size, bytes_read);
+		if ((io_result != -ENOTSUP) || (*bytes_read != 0U)) {
+			return io_result;
+		}
+
+		*bytes_read = 0U;
+		while (*bytes_read < image_size) {
+			chunk_size = MIN(image_size - *bytes_read,
+					 (size_t)AUTH_STREAM_HASH_CHUNK_SIZE);
+			io_result = io_read(image_handle,
+					    image_base + *bytes_read,
+					    chunk_size, &chunk_read);
+			if ((io_result != 0) || (chunk_read == 0U)) {
+				return io_result;
+			}
+
+			auth_mod_hash_update((void *)(image_base + *bytes_read),
+					     chunk_read);
+			*bytes_read += chunk_read;
+		}
+
+		return 0;
+	}
+#endif /* TRUSTED_BOARD_BOOT && AUTH_STREAM_HASH */
+
+	return io_read(image_handle, image_base, image_size, bytes_read);
+}
+
 /*******************************************************************************
  * Internal function to load an image at a specific address given
  * an image ID and extents of free memory.
@@ -151,7 +244,8 @@ size_t get_image_size(unsigned int image_id)
  *
  * Returns 0 on success, a negative error code otherwise.
  ******************************************************************************/
-static int load_image(unsigned int image_id, image_info_t *image_data)
+static int load_image(unsigned int image_id, image_info_t *image_data,
+		      int hash_stream)
 {
 	uintptr_t dev_handle;
 	uintptr_t image_handle;
@@ -207,7 +301,22 @@ static int load_image(unsigned int image_id, image_info_t *image_data)
 
 	/* We have enough space so load the image now */
 	/* TODO: Consider whether to try to recover/retry a partially successful read */
-	io_result = io_read(image_handle, image_base, image_size, &bytes_read);
+#if IMAGE_DECOMPRESS_STREAM && defined(IMAGE_BL2)
+	/*
+	 * A compressed image prepared by image_decompress_prepare() is
+	 * decompressed to image_base as it is read.
+	 */
+	if (image_decompress_is_pending(image_data) != 0) {
+		io_result = image_decompress_read(image_handle, image_size,
+						  &bytes_read);
+	} else {
+		io_result = read_image(image_handle, image_base, image_size,
+				       &bytes_read, hash_stream);
+	}
+#else
+	io_result = read_image(image_handle, image_base, image_size,
+			       &bytes_read, hash_stream);
+#endif
 	if ((io_result != 0) || (bytes_read < image_size)) {
 		WARN("Failed to load image id=%u (%i)\n", image_id, io_result);
 		goto exit;
@@ -220,9 +329,16 @@ exit:
 	(void)io_close(image_handle);
 	/* Ignore improbable/unrecoverable error in 'close' */
 
-	/* TODO: Consider maintaining open device connection from this bootloader stage */
-	(void)io_dev_close(dev_handle);
-	/* Ignore improbable/unrecoverable error in 'dev_close' */
+	/*
+	 * With FIP_TOC_CACHE, keep the device connection after a successful
+	 * load so that the FIP driver keeps its ToC cache and backend handle
+	 * for the next image. It is closed after a failure, in case the next
+	 * boot source is tried.
+	 */
+	if ((FIP_TOC_CACHE == 0) || (io_result != 0)) {
+		(void)io_dev_close(dev_handle);
+		/* Ignore improbable/unrecoverable error in 'dev_close' */
+	}
 
 	return io_result;
 }
@@ -231,6 +347,7 @@ static int load_auth_image_internal(unsigned int image_id,
 				    image_info_t *image_data,
 				    int is_parent_image)
 {
+	int hash_stream = 0;
 	int rc;
 
 #if TRUSTED_BOARD_BOOT
@@ -248,8 +365,15 @@ static int load_auth_image_internal(unsigned int image_id,
 	}
 #endif /* TRUSTED_BOARD_BOOT */
 
+#if TRUSTED_BOARD_BOOT && AUTH_STREAM_HASH
+	/* Hash the image as it is loaded if the authentication allows it */
+	if (dyn_is_auth_disabled() == 0) {
+		hash_stream = (auth_mod_hash_start(image_id) == 0) ? 1 : 0;
+	}
+#endif /* TRUSTED_BOARD_BOOT && AUTH_STREAM_HASH */
+
 	/* Load the image */
-	rc = load_image(image_id, image_data);
+	rc = load_image(image_id, image_data, hash_stream);
 	if (rc != 0) {
 		return rc;
 	}
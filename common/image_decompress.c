@@ -8,14 +8,35 @@
 #include <assert.h>
 #include <bl_common.h>
 #include <debug.h>
+#include <errno.h>
 #include <image_decompress.h>
+#include <io_storage.h>
+#include <platform_def.h>
 #include <stdint.h>
+#include <utils_def.h>
+
+/*
+ * Size of the chunks in which a compressed image is read and decompressed with
+ * IMAGE_DECOMPRESS_STREAM. Two chunks are taken from the temporary buffer so
+ * that a chunk is read while the other is decompressed.
+ */
+#ifndef IMAGE_DECOMPRESS_CHUNK_SIZE
+#define IMAGE_DECOMPRESS_CHUNK_SIZE	U(0x10000)
+#endif
 
 static uintptr_t decompressor_buf_base;
 static uint32_t decompressor_buf_size;
 static decompressor_t *decompressor;
 static struct image_info saved_image_info;
 
+#if IMAGE_DECOMPRESS_STREAM
+static const decompressor_stream_t *decompressor_stream;
+/* Image between image_decompress_prepare() and image_decompress() */
+static const struct image_info *stream_image_info;
+/* The stream decompressor has been started for stream_image_info */
+static int stream_started;
+#endif
+
 void image_decompress_init(uintptr_t buf_base, uint32_t buf_size,
 			   decompressor_t *_decompressor)
 {
@@ -26,6 +47,20 @@ void image_decompress_init(uintptr_t buf_base, uint32_t buf_size,
 
 void image_decompress_prepare(struct image_info *info)
 {
+#if IMAGE_DECOMPRESS_STREAM
+	if (decompressor_stream != NULL) {
+		/*
+		 * The image is loaded by image_decompress_read(), which
+		 * decompresses it straight to its final destination as it is
+		 * read, so image_info is left as it is.
+		 */
+		saved_image_info = *info;
+		stream_image_info = info;
+		stream_started = 0;
+		return;
+	}
+#endif
+
 	/*
 	 * If the image is compressed, it should be loaded into the temporary
 	 * buffer instead of its final destination.  We save image_info, then
@@ -43,6 +78,30 @@ int image_decompress(struct image_info *info)
 	uint32_t compressed_image_size, work_size;
 	int ret;
 
+#if IMAGE_DECOMPRESS_STREAM
+	if (decompressor_stream != NULL) {
+		assert(info == stream_image_info);
+		stream_image_info = NULL;
+
+		if (stream_started == 0) {
+			ERROR("Image was not decompressed while loaded\n");
+			return -EINVAL;
+		}
+
+		ret = decompressor_stream->finish(&image_base);
+		if (ret) {
+			ERROR("Failed to decompress image (err=%d)\n", ret);
+			return ret;
+		}
+
+		info->image_size = image_base - info->image_base;
+
+		flush_dcache_range(info->image_base, info->image_size);
+
+		return 0;
+	}
+#endif
+
 	/*
 	 * The size of compressed data has been filled by load_image().
 	 * Read it out before restoring image_info.
@@ -77,3 +136,136 @@ int image_decompress(struct image_info *info)
 
 	return 0;
 }
+
+#if IMAGE_DECOMPRESS_STREAM
+void image_decompress_stream_init(uintptr_t buf_base, uint32_t buf_size,
+				  const decompressor_stream_t *stream)
+{
+	/* Two input chunks, then the workspace of the decompressor */
+	assert(buf_size > (2U * IMAGE_DECOMPRESS_CHUNK_SIZE));
+
+	decompressor_buf_base = buf_base;
+	decompressor_buf_size = buf_size;
+	decompressor_stream = stream;
+}
+
+/*
+ * Return 1 if the image is to be loaded with image_decompress_read() instead
+ * of being read to image_base.
+ */
+int image_decompress_is_pending(const struct image_info *info)
+{
+	return ((decompressor_stream != NULL) && (info == stream_image_info)) ?
+		1 : 0;
+}
+
+/*
+ * Read a compressed image in chunks with asynchronous reads, so that each
+ * chunk is decompressed while the next one is being read. Returns -ENOTSUP
+ * without reading anything if the device does not support asynchronous reads.
+ */
+static int decompress_read_async(uintptr_t image_handle, size_t image_size,
+				 size_t *bytes_read)
+{
+	uintptr_t chunk_base[2];
+	size_t chunk_read;
+	unsigned int idx = 0U;
+	int io_result, ret;
+
+	chunk_base[0] = decompressor_buf_base;
+	chunk_base[1] = decompressor_buf_base + IMAGE_DECOMPRESS_CHUNK_SIZE;
+
+	*bytes_read = 0U;
+	io_result = io_read_submit(image_handle, chunk_base[0],
+			MIN(image_size, (size_t)IMAGE_DECOMPRESS_CHUNK_SIZE));
+
+	while (io_result == 0) {
+		do {
+			io_result = io_read_poll(image_handle, &chunk_read);
+		} while (io_result == -EBUSY);
+
+		if ((io_result != 0) || (chunk_read == 0U))
+			break;
+
+		*bytes_read += chunk_read;
+		if (*bytes_read < image_size) {
+			/* Start to read the next chunk before decompressing */
+			io_result = io_read_submit(image_handle,
+				chunk_base[idx ^ 1U],
+				MIN(image_size - *bytes_read,
+				    (size_t)IMAGE_DECOMPRESS_CHUNK_SIZE));
+		}
+
+		ret = decompressor_stream->feed(chunk_base[idx], chunk_read);
+		if (ret != 0) {
+			/* Do not leave a read in progress to the buffer */
+			if ((io_result == 0) && (*bytes_read < image_size)) {
+				while (io_read_poll(image_handle, &chunk_read) ==
+				       -EBUSY)
+					;
+			}
+			return ret;
+		}
+
+		if (*bytes_read == image_size)
+			break;
+
+		idx ^= 1U;
+	}
+
+	return io_result;
+}
+
+/*
+ * Load the image being prepared by reading its compressed data in chunks and
+ * feeding them to the stream decompressor. Only the chunks are held in the
+ * temporary buffer, so it needs not be as large as the compressed image.
+ */
+int image_decompress_read(uintptr_t image_handle, size_t image_size,
+			  size_t *bytes_read)
+{
+	uintptr_t work_base;
+	size_t work_size;
+	size_t chunk_read;
+	int io_result;
+
+	assert(stream_image_info != NULL);
+
+	work_base = decompressor_buf_base + (2U * IMAGE_DECOMPRESS_CHUNK_SIZE);
+	work_size = decompressor_buf_size - (2U * IMAGE_DECOMPRESS_CHUNK_SIZE);
+
+	io_result = decompressor_stream->init(saved_image_info.image_base,
+					      saved_image_info.image_max_size,
+					      work_base, work_size);
+	if (io_result != 0) {
+		ERROR("Failed to start to decompress image (err=%d)\n",
+		      io_result);
+		return io_result;
+	}
+	stream_started = 1;
+
+	io_result = decompress_read_async(image_handle, image_size,
+					  bytes_read);
+	if ((io_result != -ENOTSUP) || (*bytes_read != 0U))
+		return io_result;
+
+	*bytes_read = 0U;
+	while (*bytes_read < image_size) {
+		io_result = io_read(image_handle, decompressor_buf_base,
+				MIN(image_size - *bytes_read,
+				    (size_t)IMAGE_DECOMPRESS_CHUNK_SIZE),
+				&chunk_read);
+		if ((io_result != 0) || (chunk_read == 0U))
+			return io_result;
+
+		io_result = decompressor_stream->feed(decompressor_buf_base,
+						      chunk_read);
+		if (io_result != 0)
+			return io_result;
+
+		*bytes_read += chunk_read;
+	}
+
+	return 0;
+}
+#endif /* IMAGE_DECOMPRESS_STREAM */
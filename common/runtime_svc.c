@@ -86,6 +86,50 @@ static int32_t validate_rt_svc_desc(const rt_svc_desc_t *desc)
 	return 0;
 }
 
+#if SMC_FAST_PATH
+/*******************************************************************************
+ * Fast SMC descriptors are consulted by the exception vectors before the
+ * runtime services, so a handler registered there bypasses the service owning
+ * its function ID. Make sure each of them is unique, has a handler, and belongs
+ * to a service that has been initialised successfully.
+ ******************************************************************************/
+#define RT_FAST_SMC_DESCS_NUM	((RT_FAST_SMC_DESCS_END - \
+					RT_FAST_SMC_DESCS_START) \
+					/ sizeof(rt_fast_smc_desc_t))
+
+static void __init validate_rt_fast_smc_descs(void)
+{
+	const rt_fast_smc_desc_t *descs;
+	unsigned int i, j, idx;
+
+	assert(RT_FAST_SMC_DESCS_END >= RT_FAST_SMC_DESCS_START);
+
+	descs = (const rt_fast_smc_desc_t *) RT_FAST_SMC_DESCS_START;
+	for (i = 0U; i < RT_FAST_SMC_DESCS_NUM; i++) {
+#if SMCCC_MAJOR_VERSION == 1
+		idx = get_unique_oen_from_smc_fid(descs[i].smc_fid);
+#elif SMCCC_MAJOR_VERSION == 2
+		idx = get_rt_desc_idx(GET_SMC_OEN(descs[i].smc_fid),
+				GET_SMC_NAMESPACE(descs[i].smc_fid) & 1U);
+#endif
+		if ((descs[i].handle == NULL) ||
+		    (rt_svc_descs_indices[idx] >= RT_SVC_DECS_NUM)) {
+			ERROR("Invalid fast SMC descriptor for 0x%x\n",
+				descs[i].smc_fid);
+			panic();
+		}
+
+		for (j = 0U; j < i; j++) {
+			if (descs[j].smc_fid == descs[i].smc_fid) {
+				ERROR("Duplicate fast SMC descriptor for 0x%x\n",
+					descs[i].smc_fid);
+				panic();
+			}
+		}
+	}
+}
+#endif /* SMC_FAST_PATH */
+
 /*******************************************************************************
  * This function calls the initialisation routine in the descriptor exported by
  * a runtime service. Once a descriptor has been validated, its start & end
@@ -164,4 +208,8 @@ void __init runtime_svc_init(void)
 		for (; start_idx <= end_idx; start_idx++)
 			rt_svc_descs_indices[start_idx] = index;
 	}
+
+#if SMC_FAST_PATH
+	validate_rt_fast_smc_descs();
+#endif
 }
@@ -63,6 +63,19 @@ static int auth_get_param(const auth_param_type_desc_t *param_type_desc,
 	return 1;
 }
 
+#if AUTH_STREAM_HASH
+/*
+ * Image being hashed as it is loaded, see auth_mod_hash_start(). img_desc is
+ * NULL if there is none. The data hashed so far is [base, base + len).
+ */
+static struct {
+	const auth_img_desc_t *img_desc;
+	const auth_method_param_hash_t *param;
+	uintptr_t base;
+	size_t len;
+} auth_stream;
+#endif /* AUTH_STREAM_HASH */
+
 /*
  * Authenticate an image by matching the data hash
  *
@@ -107,6 +120,18 @@ static int auth_hash(const auth_method_param_hash_t *param,
 			img, img_len, &data_ptr, &data_len);
 	return_if_error(rc);
 
+#if AUTH_STREAM_HASH
+	/* Use the hash computed as the image was loaded if it covers the data */
+	if ((auth_stream.img_desc == img_desc) &&
+	    (auth_stream.param == param)) {
+		auth_stream.img_desc = NULL;
+		if ((auth_stream.base == (uintptr_t)data_ptr) &&
+		    (auth_stream.len == data_len)) {
+			return crypto_mod_hash_final();
+		}
+	}
+#endif /* AUTH_STREAM_HASH */
+
 	/* Ask the crypto module to verify this hash */
 	rc = crypto_mod_verify_hash(data_ptr, data_len,
 				    hash_der_ptr, hash_der_len);
@@ -335,6 +360,87 @@ void auth_mod_init(void)
 	img_parser_init();
 }
 
+#if AUTH_STREAM_HASH
+/*
+ * Start to hash an image as it is loaded. This is only done for the raw images
+ * authenticated by a hash, which is then computed over the whole image: the
+ * loader passes the data it reads to auth_mod_hash_update() and
+ * auth_mod_verify_img() only compares the resulting hash. The parent image
+ * must have been authenticated.
+ *
+ * Return: 0 = the image is hashed as it is loaded, Otherwise = it is not
+ */
+int auth_mod_hash_start(unsigned int img_id)
+{
+	const auth_img_desc_t *img_desc = NULL;
+	const auth_method_param_hash_t *param = NULL;
+	void *hash_der_ptr;
+	unsigned int hash_der_len;
+	int rc, i;
+
+	auth_stream.img_desc = NULL;
+
+	/* Get the image descriptor from the chain of trust */
+	img_desc = &cot_desc_ptr[img_id];
+	if (img_desc->img_type != IMG_RAW) {
+		return 1;
+	}
+
+	for (i = 0 ; i < AUTH_METHOD_NUM ; i++) {
+		if (img_desc->img_auth_methods[i].type == AUTH_METHOD_HASH) {
+			param = &img_desc->img_auth_methods[i].param.hash;
+			break;
+		}
+	}
+	if ((param == NULL) || (param->data->type != AUTH_PARAM_RAW_DATA)) {
+		return 1;
+	}
+
+	/* Get the hash from the parent image */
+	rc = auth_get_param(param->hash, img_desc->parent,
+			&hash_der_ptr, &hash_der_len);
+	return_if_error(rc);
+
+	rc = crypto_mod_hash_init(hash_der_ptr, hash_der_len);
+	return_if_error(rc);
+
+	auth_stream.img_desc = img_desc;
+	auth_stream.param = param;
+	auth_stream.base = 0;
+	auth_stream.len = 0;
+
+	return 0;
+}
+
+/*
+ * Hash the next part of the image started by auth_mod_hash_start(). The image
+ * must be loaded in order. If the data cannot be hashed, the image is instead
+ * hashed as a whole by auth_mod_verify_img().
+ */
+void auth_mod_hash_update(void *data_ptr, size_t data_len)
+{
+	int rc;
+
+	if ((auth_stream.img_desc == NULL) || (data_len == 0)) {
+		return;
+	}
+
+	if (auth_stream.len == 0) {
+		auth_stream.base = (uintptr_t)data_ptr;
+	} else if ((uintptr_t)data_ptr != auth_stream.base + auth_stream.len) {
+		auth_stream.img_desc = NULL;
+		return;
+	}
+
+	rc = crypto_mod_hash_update(data_ptr, data_len);
+	if (rc != 0) {
+		auth_stream.img_desc = NULL;
+		return;
+	}
+	auth_stream.len += data_len;
+}
+#endif /* AUTH_STREAM_HASH */
+
 /*
  * Authenticate a certificate/image
  *
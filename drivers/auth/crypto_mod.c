@@ -8,7 +8,8 @@
 #include <crypto_mod.h>
 #include <debug.h>
 
-/* Variable exported by the crypto library through REGISTER_CRYPTO_LIB() */
+/* Variable exported by the crypto library through REGISTER_CRYPTO_LIB() or
+ * REGISTER_CRYPTO_LIB_HASH() */
 
 /*
  * The crypto module is responsible for verifying digital signatures and hashes.
@@ -102,3 +103,55 @@ int crypto_mod_verify_hash(void *data_ptr, unsigned int data_len,
 	return crypto_lib_desc.verify_hash(data_ptr, data_len,
 					   digest_info_ptr, digest_info_len);
 }
+
+/*
+ * Start to compute a hash to be compared with the given one. The data is then
+ * passed with crypto_mod_hash_update() and the comparison is done by
+ * crypto_mod_hash_final(). Fails if the library does not support it.
+ *
+ * Parameters:
+ *
+ *   digest_info_ptr, digest_info_len: hash to be compared
+ */
+int crypto_mod_hash_init(void *digest_info_ptr, unsigned int digest_info_len)
+{
+	assert(digest_info_ptr != NULL);
+	assert(digest_info_len != 0);
+
+	if (crypto_lib_desc.hash_init == NULL) {
+		return CRYPTO_ERR_HASH;
+	}
+
+	return crypto_lib_desc.hash_init(digest_info_ptr, digest_info_len);
+}
+
+/*
+ * Add data to the hash started by crypto_mod_hash_init()
+ *
+ * Parameters:
+ *
+ *   data_ptr, data_len: data to be hashed
+ */
+int crypto_mod_hash_update(void *data_ptr, unsigned int data_len)
+{
+	assert(data_ptr != NULL);
+	assert(data_len != 0);
+
+	if (crypto_lib_desc.hash_update == NULL) {
+		return CRYPTO_ERR_HASH;
+	}
+
+	return crypto_lib_desc.hash_update(data_ptr, data_len);
+}
+
+/*
+ * Compare the hash started by crypto_mod_hash_init() with the expected one
+ */
+int crypto_mod_hash_final(void)
+{
+	if (crypto_lib_desc.hash_final == NULL) {
+		return CRYPTO_ERR_HASH;
+	}
+
+	return crypto_lib_desc.hash_final();
+}
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2017, ARM Limited and Contributors. All rights reserved.
+ * Copyright (c) 2017-2018, ARM Limited and Contributors. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  */
@@ -232,21 +232,17 @@ static int verify_signature(void *data_ptr, unsigned int data_len,
 }
 
 /*
- * Match a hash
- *
- * Digest info is passed in DER format following the ASN.1 structure detailed
- * above.
+ * Get the hash from a digest info, passed in DER format following the ASN.1
+ * structure detailed above. Only SHA256 is supported.
  */
-static int verify_hash(void *data_ptr, unsigned int data_len,
-		       void *digest_info_ptr, unsigned int digest_info_len)
+static int get_digest_info(void *digest_info_ptr, unsigned int digest_info_len,
+			   uint8_t **hash)
 {
 	mbedtls_asn1_buf hash_oid, params;
 	mbedtls_md_type_t md_alg;
-	uint8_t *p, *end, *hash;
-	CCHashResult_t pubKeyHash;
+	uint8_t *p, *end;
 	size_t len;
 	int rc;
-	CCError_t error;
 
 	/* Digest info should be an MBEDTLS_ASN1_SEQUENCE */
 	p = digest_info_ptr;
@@ -277,13 +273,26 @@ static int verify_hash(void *data_ptr, unsigned int data_len,
 	if (len != HASH_RESULT_SIZE_IN_BYTES)
 		return CRYPTO_ERR_HASH;
 
+	*hash = p;
+
+	return CRYPTO_SUCCESS;
+}
+
+/*
+ * Hash data with CryptoCell and compare the result with the given hash
+ */
+static int match_hash(void *data_ptr, unsigned int data_len, uint8_t *hash)
+{
+	CCHashResult_t pubKeyHash;
+	CCError_t error;
+	int rc;
+
 	/*
 	 * CryptoCell utilises DMA internally to transfer data. Flush the data
 	 * from caches.
 	 */
 	flush_dcache_range((uintptr_t)data_ptr, data_len);
 
-	hash = p;
 	error = SBROM_CryptoHash((uintptr_t)PLAT_CRYPTOCELL_BASE,
 			(uintptr_t)data_ptr, data_len, pubKeyHash);
 	if (error != CC_OK)
@@ -296,9 +305,84 @@ static int verify_hash(void *data_ptr, unsigned int data_len,
 	return CRYPTO_SUCCESS;
 }
 
+/*
+ * Match a hash
+ *
+ * Digest info is passed in DER format following the ASN.1 structure detailed
+ * above.
+ */
+static int verify_hash(void *data_ptr, unsigned int data_len,
+		       void *digest_info_ptr, unsigned int digest_info_len)
+{
+	uint8_t *hash;
+	int rc;
+
+	rc = get_digest_info(digest_info_ptr, digest_info_len, &hash);
+	if (rc != CRYPTO_SUCCESS)
+		return rc;
+
+	return match_hash(data_ptr, data_len, hash);
+}
+
+/*
+ * Incremental hash matching. The SBROM API only hashes a buffer in one go, so
+ * the data passed to hash_update() must be contiguous in memory and it is
+ * hashed by hash_final().
+ */
+static uint8_t hash_expected[HASH_RESULT_SIZE_IN_BYTES];
+static uintptr_t hash_base;
+static size_t hash_len;
+static int hash_started;
+
+static int hash_init(void *digest_info_ptr, unsigned int digest_info_len)
+{
+	uint8_t *hash;
+	int rc;
+
+	hash_started = 0;
+
+	rc = get_digest_info(digest_info_ptr, digest_info_len, &hash);
+	if (rc != CRYPTO_SUCCESS)
+		return rc;
+
+	memcpy(hash_expected, hash, HASH_RESULT_SIZE_IN_BYTES);
+	hash_base = 0;
+	hash_len = 0;
+	hash_started = 1;
+
+	return CRYPTO_SUCCESS;
+}
+
+static int hash_update(void *data_ptr, unsigned int data_len)
+{
+	if (!hash_started)
+		return CRYPTO_ERR_HASH;
+
+	if (hash_len == 0) {
+		hash_base = (uintptr_t)data_ptr;
+	} else if ((uintptr_t)data_ptr != hash_base + hash_len) {
+		hash_started = 0;
+		return CRYPTO_ERR_HASH;
+	}
+	hash_len += data_len;
+
+	return CRYPTO_SUCCESS;
+}
+
+static int hash_final(void)
+{
+	if (!hash_started || (hash_len == 0))
+		return CRYPTO_ERR_HASH;
+
+	hash_started = 0;
+
+	return match_hash((void *)hash_base, hash_len, hash_expected);
+}
+
 /*
  * Register crypto library descriptor
  */
-REGISTER_CRYPTO_LIB(LIB_NAME, init, verify_signature, verify_hash);
+REGISTER_CRYPTO_LIB_HASH(LIB_NAME, init, verify_signature, verify_hash,
+			 hash_init, hash_update, hash_final);
 
 
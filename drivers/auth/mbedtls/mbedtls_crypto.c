@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2015-2017, ARM Limited and Contributors. All rights reserved.
+ * Copyright (c) 2015-2018, ARM Limited and Contributors. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  */
@@ -135,19 +135,16 @@ end2:
 }
 
 /*
- * Match a hash
- *
- * Digest info is passed in DER format following the ASN.1 structure detailed
- * above.
+ * Get the hash algorithm and the hash from a digest info, passed in DER format
+ * following the ASN.1 structure detailed above.
  */
-static int verify_hash(void *data_ptr, unsigned int data_len,
-		       void *digest_info_ptr, unsigned int digest_info_len)
+static int get_digest_info(void *digest_info_ptr, unsigned int digest_info_len,
+			   const mbedtls_md_info_t **md_info,
+			   unsigned char **hash)
 {
 	mbedtls_asn1_buf hash_oid, params;
 	mbedtls_md_type_t md_alg;
-	const mbedtls_md_info_t *md_info;
-	unsigned char *p, *end, *hash;
-	unsigned char data_hash[MBEDTLS_MD_MAX_SIZE];
+	unsigned char *p, *end;
 	size_t len;
 	int rc;
 
@@ -171,8 +168,8 @@ static int verify_hash(void *data_ptr, unsigned int data_len,
 		return CRYPTO_ERR_HASH;
 	}
 
-	md_info = mbedtls_md_info_from_type(md_alg);
-	if (md_info == NULL) {
+	*md_info = mbedtls_md_info_from_type(md_alg);
+	if (*md_info == NULL) {
 		return CRYPTO_ERR_HASH;
 	}
 
@@ -183,10 +180,33 @@ static int verify_hash(void *data_ptr, unsigned int data_len,
 	}
 
 	/* Length of hash must match the algorithm's size */
-	if (len != mbedtls_md_get_size(md_info)) {
+	if (len != mbedtls_md_get_size(*md_info)) {
 		return CRYPTO_ERR_HASH;
 	}
-	hash = p;
+	*hash = p;
+
+	return CRYPTO_SUCCESS;
+}
+
+/*
+ * Match a hash
+ *
+ * Digest info is passed in DER format following the ASN.1 structure detailed
+ * above.
+ */
+static int verify_hash(void *data_ptr, unsigned int data_len,
+		       void *digest_info_ptr, unsigned int digest_info_len)
+{
+	const mbedtls_md_info_t *md_info;
+	unsigned char *p, *hash;
+	unsigned char data_hash[MBEDTLS_MD_MAX_SIZE];
+	int rc;
+
+	rc = get_digest_info(digest_info_ptr, digest_info_len,
+			     &md_info, &hash);
+	if (rc != CRYPTO_SUCCESS) {
+		return rc;
+	}
 
 	/* Calculate the hash of the data */
 	p = (unsigned char *)data_ptr;
@@ -204,7 +224,101 @@ static int verify_hash(void *data_ptr, unsigned int data_len,
 	return CRYPTO_SUCCESS;
 }
 
+/*
+ * Incremental hash matching. Images are loaded one at a time, so a single
+ * context is enough. The expected hash is copied, as the digest info may not
+ * outlive the call to hash_init().
+ */
+static mbedtls_md_context_t hash_ctx;
+static unsigned char hash_expected[MBEDTLS_MD_MAX_SIZE];
+static size_t hash_size;	/* 0 if no hash is in progress */
+
+/*
+ * Start to compute a hash to be matched with the one in the digest info.
+ * A hash that was started and not finished is discarded.
+ */
+static int hash_init(void *digest_info_ptr, unsigned int digest_info_len)
+{
+	const mbedtls_md_info_t *md_info;
+	unsigned char *hash;
+	int rc;
+
+	mbedtls_md_free(&hash_ctx);
+	mbedtls_md_init(&hash_ctx);
+	hash_size = 0;
+
+	rc = get_digest_info(digest_info_ptr, digest_info_len,
+			     &md_info, &hash);
+	if (rc != CRYPTO_SUCCESS) {
+		return rc;
+	}
+
+	rc = mbedtls_md_setup(&hash_ctx, md_info, 0);
+	if (rc == 0) {
+		rc = mbedtls_md_starts(&hash_ctx);
+	}
+	if (rc != 0) {
+		mbedtls_md_free(&hash_ctx);
+		return CRYPTO_ERR_HASH;
+	}
+
+	hash_size = mbedtls_md_get_size(md_info);
+	memcpy(hash_expected, hash, hash_size);
+
+	return CRYPTO_SUCCESS;
+}
+
+/*
+ * Add data to the hash started by hash_init()
+ */
+static int hash_update(void *data_ptr, unsigned int data_len)
+{
+	int rc;
+
+	if (hash_size == 0) {
+		return CRYPTO_ERR_HASH;
+	}
+
+	rc = mbedtls_md_update(&hash_ctx, (unsigned char *)data_ptr,
+			       data_len);
+	if (rc != 0) {
+		return CRYPTO_ERR_HASH;
+	}
+
+	return CRYPTO_SUCCESS;
+}
+
+/*
+ * Finish the hash started by hash_init() and match it with the expected one
+ */
+static int hash_final(void)
+{
+	unsigned char data_hash[MBEDTLS_MD_MAX_SIZE];
+	size_t len = hash_size;
+	int rc;
+
+	if (len == 0) {
+		return CRYPTO_ERR_HASH;
+	}
+
+	rc = mbedtls_md_finish(&hash_ctx, data_hash);
+	mbedtls_md_free(&hash_ctx);
+	hash_size = 0;
+	if (rc != 0) {
+		return CRYPTO_ERR_HASH;
+	}
+
+	/* Compare values */
+	rc = memcmp(data_hash, hash_expected, len);
+	if (rc != 0) {
+		return CRYPTO_ERR_HASH;
+	}
+
+	return CRYPTO_SUCCESS;
+}
+
 /*
  * Register crypto library descriptor
  */
-REGISTER_CRYPTO_LIB(LIB_NAME, init, verify_signature, verify_hash);
+REGISTER_CRYPTO_LIB_HASH(LIB_NAME, init, verify_signature, verify_hash,
+			 hash_init, hash_update, hash_final);
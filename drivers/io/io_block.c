@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2016-2017, ARM Limited and Contributors. All rights reserved.
+ * Copyright (c) 2016-2018, ARM Limited and Contributors. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  */
@@ -19,8 +19,16 @@ typedef struct {
 	uintptr_t		base;
 	size_t			file_pos;
 	size_t			size;
+	/* Read started by block_read_submit() */
+	int			submit_state;
+	size_t			submit_length;
 } block_dev_state_t;
 
+/* State of the read started by block_read_submit() */
+#define BLOCK_SUBMIT_NONE	0	/* No read in progress */
+#define BLOCK_SUBMIT_DEV	1	/* Read in progress in the device */
+#define BLOCK_SUBMIT_DONE	2	/* Read already done */
+
 #define is_power_of_2(x)	((x != 0) && ((x & (x - 1)) == 0))
 
 io_type_t device_type_block(void);
@@ -30,6 +38,9 @@ static int block_open(io_dev_info_t *dev_info, const uintptr_t spec,
 static int block_seek(io_entity_t *entity, int mode, ssize_t offset);
 static int block_read(io_entity_t *entity, uintptr_t buffer, size_t length,
 		      size_t *length_read);
+static int block_read_submit(io_entity_t *entity, uintptr_t buffer,
+			     size_t length);
+static int block_read_poll(io_entity_t *entity, size_t *length_read);
 static int block_write(io_entity_t *entity, const uintptr_t buffer,
 		       size_t length, size_t *length_written);
 static int block_close(io_entity_t *entity);
@@ -46,6 +57,8 @@ static const io_dev_funcs_t block_dev_funcs = {
 	.seek		= block_seek,
 	.size		= NULL,
 	.read		= block_read,
+	.read_submit	= block_read_submit,
+	.read_poll	= block_read_poll,
 	.write		= block_write,
 	.close		= block_close,
 	.dev_init	= NULL,
@@ -58,6 +71,9 @@ static io_dev_info_t dev_info_pool[MAX_IO_BLOCK_DEVICES];
 /* Track number of allocated block state */
 static unsigned int block_dev_count;
 
+/* Bytes read by all block devices, see io_block_get_stats() */
+static io_block_stats_t block_stats;
+
 io_type_t device_type_block(void)
 {
 	return IO_TYPE_BLOCK;
@@ -138,6 +154,7 @@ static int block_open(io_dev_info_t *dev_info, const uintptr_t spec,
 	cur->base = region->offset;
 	cur->size = region->length;
 	cur->file_pos = 0;
+	cur->submit_state = BLOCK_SUBMIT_NONE;
 
 	entity->info = (uintptr_t)cur;
 	return 0;
@@ -236,6 +253,13 @@ static int block_seek(io_entity_t *entity, int mode, ssize_t offset)
  *
  * Additionally, the IO driver has an underlying buffer that is at least
  * one block-size and may be big enough to allow.
+ *
+ * When file_pos and the current position in the caller's buffer are both
+ * block aligned, the whole blocks are read straight into the caller's buffer
+ * instead, without going through the underlying buffer. Each such read is
+ * limited to the size of the underlying buffer, which the low level driver is
+ * known to handle. Only the unaligned leading and trailing blocks are then
+ * read through the underlying buffer and copied.
  */
 static int block_read(io_entity_t *entity, uintptr_t buffer, size_t length,
 		      size_t *length_read)
@@ -276,6 +300,28 @@ static int block_read(io_entity_t *entity, uintptr_t buffer, size_t length,
 	 */
 	count = 0;
 	for (left = length; left > 0; left -= nbytes) {
+		/*
+		 * Read the aligned whole blocks directly into the user
+		 * buffer if possible.
+		 */
+		if (((cur->file_pos & (block_size - 1)) == 0) &&
+		    (((buffer + count) & (block_size - 1)) == 0) &&
+		    (left >= block_size)) {
+			lba = (cur->file_pos + cur->base) / block_size;
+			request = MIN(left, buf->length) & ~(block_size - 1);
+
+			nbytes = ops->read(lba, buffer + count, request);
+			if (nbytes == 0) {
+				return -EIO;
+			}
+			nbytes = MIN(nbytes, request);
+
+			block_stats.direct += nbytes;
+			cur->file_pos += nbytes;
+			count += nbytes;
+			continue;
+		}
+
 		/*
 		 * We must only request operations aligned to the block
 		 * size. Therefore if file_pos is not block-aligned,
@@ -333,6 +379,7 @@ static int block_read(io_entity_t *entity, uintptr_t buffer, size_t length,
 		       (void *)(buf->offset + skip),
 		       nbytes);
 
+		block_stats.bounced += nbytes;
 		cur->file_pos += nbytes;
 		count += nbytes;
 	}
@@ -342,6 +389,109 @@ static int block_read(io_entity_t *entity, uintptr_t buffer, size_t length,
 	return 0;
 }
 
+/*
+ * Start to read data, for devices which support asynchronous reads. Only the
+ * aligned whole blocks, which can be read straight into the caller's buffer
+ * (see block_read()), are read asynchronously, up to the size of the
+ * underlying buffer. Other data is read synchronously, up to the next block
+ * boundary if the file position and the caller's buffer are equally
+ * misaligned, so that the next read can be asynchronous. As with block_read(),
+ * fewer bytes than requested may be read.
+ */
+static int block_read_submit(io_entity_t *entity, uintptr_t buffer,
+			     size_t length)
+{
+	block_dev_state_t *cur;
+	io_block_spec_t *buf;
+	io_block_ops_t *ops;
+	int lba;
+	size_t block_size, skip, request;
+	int result;
+
+	assert(entity->info != (uintptr_t)NULL);
+	cur = (block_dev_state_t *)entity->info;
+	ops = &(cur->dev_spec->ops);
+	buf = &(cur->dev_spec->buffer);
+	block_size = cur->dev_spec->block_size;
+	assert((length <= cur->size) &&
+	       (length > 0) &&
+	       (cur->submit_state == BLOCK_SUBMIT_NONE));
+
+	if ((ops->read_submit == NULL) || (ops->read_poll == NULL)) {
+		return -ENOTSUP;
+	}
+
+	skip = cur->file_pos & (block_size - 1);
+	if ((skip == 0) &&
+	    ((buffer & (block_size - 1)) == 0) &&
+	    (length >= block_size)) {
+		lba = (cur->file_pos + cur->base) / block_size;
+		request = MIN(length, buf->length) & ~(block_size - 1);
+
+		result = ops->read_submit(lba, buffer, request);
+		if (result != 0) {
+			return result;
+		}
+
+		cur->submit_length = request;
+		cur->submit_state = BLOCK_SUBMIT_DEV;
+		return 0;
+	}
+
+	if (((buffer - cur->file_pos) & (block_size - 1)) == 0) {
+		length = MIN(length, block_size - skip);
+	}
+
+	result = block_read(entity, buffer, length, &cur->submit_length);
+	if (result != 0) {
+		return result;
+	}
+
+	cur->submit_state = BLOCK_SUBMIT_DONE;
+	return 0;
+}
+
+/* Check whether the read started by block_read_submit() is complete */
+static int block_read_poll(io_entity_t *entity, size_t *length_read)
+{
+	block_dev_state_t *cur;
+	io_block_ops_t *ops;
+	size_t nbytes;
+	int result;
+
+	assert(entity->info != (uintptr_t)NULL);
+	cur = (block_dev_state_t *)entity->info;
+	ops = &(cur->dev_spec->ops);
+
+	switch (cur->submit_state) {
+	case BLOCK_SUBMIT_DEV:
+		result = ops->read_poll(&nbytes);
+		if (result == -EBUSY) {
+			return result;
+		}
+
+		cur->submit_state = BLOCK_SUBMIT_NONE;
+		if (result != 0) {
+			return result;
+		}
+		if (nbytes == 0) {
+			return -EIO;
+		}
+		nbytes = MIN(nbytes, cur->submit_length);
+
+		block_stats.direct += nbytes;
+		cur->file_pos += nbytes;
+		*length_read = nbytes;
+		return 0;
+	case BLOCK_SUBMIT_DONE:
+		cur->submit_state = BLOCK_SUBMIT_NONE;
+		*length_read = cur->submit_length;
+		return 0;
+	default:
+		return -EINVAL;
+	}
+}
+
 /*
  * This function allows the caller to write any number of bytes
  * from any position. It hides from the caller that the low level
@@ -522,6 +672,9 @@ static int block_dev_open(const uintptr_t dev_spec, io_dev_info_t **dev_info)
 
 static int block_dev_close(io_dev_info_t *dev_info)
 {
+	VERBOSE("io_block: %llu bytes read directly, %llu bounced\n",
+		block_stats.direct, block_stats.bounced);
+
 	return free_dev_info(dev_info);
 }
 
@@ -543,3 +696,11 @@ int register_io_dev_block(const io_dev_connector_t **dev_con)
 		*dev_con = &block_dev_connector;
 	return result;
 }
+
+/* Return the number of bytes read directly and through the underlying buffer */
+void io_block_get_stats(io_block_stats_t *stats)
+{
+	assert(stats != NULL);
+
+	*stats = block_stats;
+}
@@ -23,6 +23,10 @@
 #define MAX_FIP_DEVICES		1
 #endif
 
+#ifndef FIP_TOC_CACHE_ENTRIES
+#define FIP_TOC_CACHE_ENTRIES	16
+#endif
+
 /* Useful for printing UUIDs when debugging.*/
 #define PRINT_UUID2(x)								\
 	"%08x-%04hx-%04hx-%02hhx%02hhx-%02hhx%02hhx%02hhx%02hhx%02hhx%02hhx",	\
@@ -34,6 +38,8 @@
 typedef struct {
 	unsigned int file_pos;
 	fip_toc_entry_t entry;
+	/* Backend handle of the read started by fip_file_read_submit() */
+	uintptr_t submit_handle;
 } file_state_t;
 
 /*
@@ -64,6 +70,26 @@ static io_dev_info_t dev_info_pool[MAX_FIP_DEVICES];
 /* Track number of allocated fip devices */
 static unsigned int fip_dev_count;
 
+#if FIP_TOC_CACHE
+/*
+ * Copy of the ToC of the FIP and handle of its backend, which stays open.
+ * Both are set up by fip_dev_init() for the FIP image 'image_id' and dropped
+ * by fip_dev_close() or when fip_dev_init() is called for another FIP image.
+ * If the ToC has more entries than the cache holds, 'complete' is 0 and the
+ * files not found in the cache are looked up in the ToC on storage.
+ */
+static struct {
+	int valid;
+	int complete;
+	unsigned int count;
+	unsigned int image_id;
+	uintptr_t backend_handle;
+	fip_toc_entry_t entries[FIP_TOC_CACHE_ENTRIES];
+} toc_cache;
+
+static fip_toc_stats_t toc_stats;
+#endif /* FIP_TOC_CACHE */
+
 /* Firmware Image Package driver functions */
 static int fip_dev_open(const uintptr_t dev_spec, io_dev_info_t **dev_info);
 static int fip_file_open(io_dev_info_t *dev_info, const uintptr_t spec,
@@ -71,6 +97,9 @@ static int fip_file_open(io_dev_info_t *dev_info, const uintptr_t spec,
 static int fip_file_len(io_entity_t *entity, size_t *length);
 static int fip_file_read(io_entity_t *entity, uintptr_t buffer, size_t length,
 			  size_t *length_read);
+static int fip_file_read_submit(io_entity_t *entity, uintptr_t buffer,
+				size_t length);
+static int fip_file_read_poll(io_entity_t *entity, size_t *length_read);
 static int fip_file_close(io_entity_t *entity);
 static int fip_dev_init(io_dev_info_t *dev_info, const uintptr_t init_params);
 static int fip_dev_close(io_dev_info_t *dev_info);
@@ -94,6 +123,90 @@ static inline int is_valid_header(fip_toc_header_t *header)
 }
 
 
+/*
+ * Open the backend to access the FIP image. With FIP_TOC_CACHE, this returns
+ * the handle kept open by fip_dev_init().
+ */
+static int fip_backend_open(uintptr_t *backend_handle)
+{
+#if FIP_TOC_CACHE
+	if (toc_cache.valid != 0) {
+		*backend_handle = toc_cache.backend_handle;
+		return 0;
+	}
+#endif
+	return io_open(backend_dev_handle, backend_image_spec, backend_handle);
+}
+
+
+static void fip_backend_close(uintptr_t backend_handle)
+{
+#if FIP_TOC_CACHE
+	if ((toc_cache.valid != 0) &&
+	    (backend_handle == toc_cache.backend_handle)) {
+		return;
+	}
+#endif
+	io_close(backend_handle);
+}
+
+
+#if FIP_TOC_CACHE
+/*
+ * Read the ToC that follows the header into the cache and keep the backend
+ * open.
+ */
+static int fip_toc_cache_fill(unsigned int image_id, uintptr_t backend_handle)
+{
+	fip_toc_entry_t entry;
+	size_t bytes_read;
+	int result;
+
+	toc_cache.count = 0;
+	toc_cache.complete = 0;
+	for (;;) {
+		result = io_read(backend_handle, (uintptr_t)&entry,
+				 sizeof(entry), &bytes_read);
+		if (result != 0) {
+			WARN("Failed to read FIP (%i)\n", result);
+			return -ENOENT;
+		}
+
+		if (compare_uuids(&entry.uuid, &uuid_null) == 0) {
+			toc_cache.complete = 1;
+			break;
+		}
+
+		if (toc_cache.count == (unsigned int)FIP_TOC_CACHE_ENTRIES) {
+			break;
+		}
+
+		toc_cache.entries[toc_cache.count] = entry;
+		toc_cache.count++;
+	}
+
+	toc_cache.image_id = image_id;
+	toc_cache.backend_handle = backend_handle;
+	toc_cache.valid = 1;
+
+	VERBOSE("FIP ToC cached: %u entries%s\n", toc_cache.count,
+		(toc_cache.complete != 0) ? "" : " (incomplete)");
+
+	return 0;
+}
+
+
+/* Drop the ToC cache and close the backend */
+static void fip_toc_cache_drop(void)
+{
+	if (toc_cache.valid != 0) {
+		toc_cache.valid = 0;
+		io_close(toc_cache.backend_handle);
+	}
+}
+#endif /* FIP_TOC_CACHE */
+
+
 /* Identify the device type as a virtual driver */
 static io_type_t device_type_fip(void)
 {
@@ -112,6 +225,8 @@ static const io_dev_funcs_t fip_dev_funcs = {
 	.seek = NULL,
 	.size = fip_file_len,
 	.read = fip_file_read,
+	.read_submit = fip_file_read_submit,
+	.read_poll = fip_file_read_poll,
 	.write = NULL,
 	.close = fip_file_close,
 	.dev_init = fip_dev_init,
@@ -220,6 +335,18 @@ static int fip_dev_init(io_dev_info_t *dev_info, const uintptr_t init_params)
 	fip_toc_header_t header;
 	size_t bytes_read;
 
+#if FIP_TOC_CACHE
+	/* The FIP is already known, no need to access it again */
+	if (toc_cache.valid != 0) {
+		if (toc_cache.image_id == image_id) {
+			return 0;
+		}
+
+		/* The cache holds the ToC of another FIP image */
+		fip_toc_cache_drop();
+	}
+#endif
+
 	/* Obtain a reference to the image by querying the platform layer */
 	result = plat_get_image_source(image_id, &backend_dev_handle,
 				       &backend_image_spec);
@@ -250,6 +377,15 @@ static int fip_dev_init(io_dev_info_t *dev_info, const uintptr_t init_params)
 		}
 	}
 
+#if FIP_TOC_CACHE
+	if (result == 0) {
+		result = fip_toc_cache_fill(image_id, backend_handle);
+		if (result == 0) {
+			goto fip_dev_init_exit;
+		}
+	}
+#endif
+
 	io_close(backend_handle);
 
  fip_dev_init_exit:
@@ -261,6 +397,12 @@ static int fip_dev_close(io_dev_info_t *dev_info)
 {
 	/* TODO: Consider tracking open files and cleaning them up here */
 
+#if FIP_TOC_CACHE
+	VERBOSE("FIP ToC cache: %u hits, %u misses\n", toc_stats.hits,
+		toc_stats.misses);
+	fip_toc_cache_drop();
+#endif
+
 	/* Clear the backend. */
 	backend_dev_handle = (uintptr_t)NULL;
 	backend_image_spec = (uintptr_t)NULL;
@@ -278,6 +420,9 @@ static int fip_file_open(io_dev_info_t *dev_info, const uintptr_t spec,
 	const io_uuid_spec_t *uuid_spec = (io_uuid_spec_t *)spec;
 	size_t bytes_read;
 	int found_file = 0;
+#if FIP_TOC_CACHE
+	unsigned int i;
+#endif
 
 	assert(uuid_spec != NULL);
 	assert(entity != NULL);
@@ -293,9 +438,30 @@ static int fip_file_open(io_dev_info_t *dev_info, const uintptr_t spec,
 		return -ENOMEM;
 	}
 
+#if FIP_TOC_CACHE
+	/* Look the file up in the cache first */
+	if (toc_cache.valid != 0) {
+		for (i = 0; i < toc_cache.count; i++) {
+			if (compare_uuids(&toc_cache.entries[i].uuid,
+					  &uuid_spec->uuid) == 0) {
+				toc_stats.hits++;
+				current_file.entry = toc_cache.entries[i];
+				current_file.file_pos = 0;
+				entity->info = (uintptr_t)&current_file;
+				return 0;
+			}
+		}
+
+		if (toc_cache.complete != 0) {
+			toc_stats.hits++;
+			return -ENOENT;
+		}
+	}
+	toc_stats.misses++;
+#endif
+
 	/* Attempt to access the FIP image */
-	result = io_open(backend_dev_handle, backend_image_spec,
-			 &backend_handle);
+	result = fip_backend_open(&backend_handle);
 	if (result != 0) {
 		WARN("Failed to open Firmware Image Package (%i)\n", result);
 		result = -ENOENT;
@@ -342,7 +508,7 @@ static int fip_file_open(io_dev_info_t *dev_info, const uintptr_t spec,
 	}
 
  fip_file_open_close:
-	io_close(backend_handle);
+	fip_backend_close(backend_handle);
 
  fip_file_open_exit:
 	return result;
@@ -376,8 +542,7 @@ static int fip_file_read(io_entity_t *entity, uintptr_t buffer, size_t length,
 	assert(entity->info != (uintptr_t)NULL);
 
 	/* Open the backend, attempt to access the blob image */
-	result = io_open(backend_dev_handle, backend_image_spec,
-			 &backend_handle);
+	result = fip_backend_open(&backend_handle);
 	if (result != 0) {
 		WARN("Failed to open FIP (%i)\n", result);
 		result = -ENOENT;
@@ -409,13 +574,94 @@ static int fip_file_read(io_entity_t *entity, uintptr_t buffer, size_t length,
 
 /* Close the backend. */
  fip_file_read_close:
-	io_close(backend_handle);
+	fip_backend_close(backend_handle);
 
  fip_file_read_exit:
 	return result;
 }
 
 
+/*
+ * Start to read data from a file in package, if the backend supports
+ * asynchronous reads. The backend is kept open until the read is complete.
+ */
+static int fip_file_read_submit(io_entity_t *entity, uintptr_t buffer,
+				size_t length)
+{
+	int result;
+	file_state_t *fp;
+	size_t file_offset;
+	uintptr_t backend_handle;
+
+	assert(entity != NULL);
+	assert(entity->info != (uintptr_t)NULL);
+
+	fp = (file_state_t *)entity->info;
+	assert(fp->submit_handle == (uintptr_t)NULL);
+
+	/* Open the backend, attempt to access the blob image */
+	result = fip_backend_open(&backend_handle);
+	if (result != 0) {
+		WARN("Failed to open FIP (%i)\n", result);
+		return -ENOENT;
+	}
+
+	/* Seek to the position in the FIP where the payload lives */
+	file_offset = fp->entry.offset_address + fp->file_pos;
+	result = io_seek(backend_handle, IO_SEEK_SET, file_offset);
+	if (result != 0) {
+		WARN("fip_file_read_submit: failed to seek\n");
+		result = -ENOENT;
+	} else {
+		result = io_read_submit(backend_handle, buffer, length);
+	}
+
+	if (result != 0) {
+		fip_backend_close(backend_handle);
+		return result;
+	}
+
+	fp->submit_handle = backend_handle;
+
+	return 0;
+}
+
+
+/* Check whether the read started by fip_file_read_submit() is complete */
+static int fip_file_read_poll(io_entity_t *entity, size_t *length_read)
+{
+	int result;
+	file_state_t *fp;
+	size_t bytes_read;
+
+	assert(entity != NULL);
+	assert(length_read != NULL);
+	assert(entity->info != (uintptr_t)NULL);
+
+	fp = (file_state_t *)entity->info;
+	assert(fp->submit_handle != (uintptr_t)NULL);
+
+	result = io_read_poll(fp->submit_handle, &bytes_read);
+	if (result == -EBUSY) {
+		return result;
+	}
+
+	fip_backend_close(fp->submit_handle);
+	fp->submit_handle = (uintptr_t)NULL;
+
+	if (result != 0) {
+		WARN("Failed to read payload (%i)\n", result);
+		return -ENOENT;
+	}
+
+	/* Set caller length and new file position. */
+	*length_read = bytes_read;
+	fp->file_pos += bytes_read;
+
+	return 0;
+}
+
+
 /* Close a file in package */
 static int fip_file_close(io_entity_t *entity)
 {
@@ -450,3 +696,13 @@ int register_io_dev_fip(const io_dev_connector_t **dev_con)
 
 	return result;
 }
+
+#if FIP_TOC_CACHE
+/* Return the number of files looked up in the ToC cache and on storage */
+void fip_get_toc_stats(fip_toc_stats_t *stats)
+{
+	assert(stats != NULL);
+
+	*stats = toc_stats;
+}
+#endif /* FIP_TOC_CACHE */
@@ -25,6 +25,9 @@ typedef struct {
 	uintptr_t	base;
 	size_t		file_pos;
 	size_t		size;
+	/* Read started by memmap_block_read_submit(), 0 length if none */
+	uintptr_t	submit_buffer;
+	size_t		submit_length;
 } file_state_t;
 
 static file_state_t current_file = {0};
@@ -44,6 +47,9 @@ static int memmap_block_seek(io_entity_t *entity, int mode,
 static int memmap_block_len(io_entity_t *entity, size_t *length);
 static int memmap_block_read(io_entity_t *entity, uintptr_t buffer,
 			     size_t length, size_t *length_read);
+static int memmap_block_read_submit(io_entity_t *entity, uintptr_t buffer,
+				    size_t length);
+static int memmap_block_read_poll(io_entity_t *entity, size_t *length_read);
 static int memmap_block_write(io_entity_t *entity, const uintptr_t buffer,
 			      size_t length, size_t *length_written);
 static int memmap_block_close(io_entity_t *entity);
@@ -61,6 +67,8 @@ static const io_dev_funcs_t memmap_dev_funcs = {
 	.seek = memmap_block_seek,
 	.size = memmap_block_len,
 	.read = memmap_block_read,
+	.read_submit = memmap_block_read_submit,
+	.read_poll = memmap_block_read_poll,
 	.write = memmap_block_write,
 	.close = memmap_block_close,
 	.dev_init = NULL,
@@ -189,6 +197,52 @@ static int memmap_block_read(io_entity_t *entity, uintptr_t buffer,
 }
 
 
+/*
+ * Start to read data from a file on the memmap device. There is no engine to
+ * do the copy in the background, so it is done by memmap_block_read_poll().
+ * This stands in for a DMA capable device, e.g. on QEMU which loads the images
+ * from memory mapped flash, so that the users of asynchronous reads can be
+ * run on such platforms.
+ */
+static int memmap_block_read_submit(io_entity_t *entity, uintptr_t buffer,
+				    size_t length)
+{
+	file_state_t *fp;
+
+	assert(entity != NULL);
+
+	fp = (file_state_t *) entity->info;
+
+	assert(fp->submit_length == 0U);
+	assert((fp->file_pos + length >= fp->file_pos) &&
+	       (fp->file_pos + length <= fp->size));
+
+	fp->submit_buffer = buffer;
+	fp->submit_length = length;
+
+	return 0;
+}
+
+
+/* Complete the read started by memmap_block_read_submit() */
+static int memmap_block_read_poll(io_entity_t *entity, size_t *length_read)
+{
+	file_state_t *fp;
+	size_t length;
+
+	assert(entity != NULL);
+
+	fp = (file_state_t *) entity->info;
+
+	length = fp->submit_length;
+	assert(length != 0U);
+	fp->submit_length = 0U;
+
+	return memmap_block_read(entity, fp->submit_buffer, length,
+				 length_read);
+}
+
+
 /* Write data to a file on the memmap device */
 static int memmap_block_write(io_entity_t *entity, const uintptr_t buffer,
 			      size_t length, size_t *length_written)
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2014-2017, ARM Limited and Contributors. All rights reserved.
+ * Copyright (c) 2014-2018, ARM Limited and Contributors. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  */
@@ -292,6 +292,43 @@ int io_read(uintptr_t handle,
 }
 
 
+/* Start to read data from an IO entity */
+int io_read_submit(uintptr_t handle,
+		uintptr_t buffer,
+		size_t length)
+{
+	int result = -ENOTSUP;
+	assert(is_valid_entity(handle));
+
+	io_entity_t *entity = (io_entity_t *)handle;
+
+	io_dev_info_t *dev = entity->dev_handle;
+
+	if (dev->funcs->read_submit != NULL)
+		result = dev->funcs->read_submit(entity, buffer, length);
+
+	return result;
+}
+
+
+/* Check whether a read started by io_read_submit() is complete */
+int io_read_poll(uintptr_t handle,
+		size_t *length_read)
+{
+	int result = -ENOTSUP;
+	assert(is_valid_entity(handle));
+
+	io_entity_t *entity = (io_entity_t *)handle;
+
+	io_dev_info_t *dev = entity->dev_handle;
+
+	if (dev->funcs->read_poll != NULL)
+		result = dev->funcs->read_poll(entity, length_read);
+
+	return result;
+}
+
+
 /* Write data to an IO entity */
 int io_write(uintptr_t handle,
 		const uintptr_t buffer,
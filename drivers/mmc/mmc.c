@@ -28,6 +28,11 @@ static unsigned char mmc_ext_csd[512] __aligned(16);
 static unsigned int mmc_flags;
 static struct mmc_device_info *mmc_dev_info;
 static unsigned int rca;
+/* Read in progress, mmc_read_size is 0 if none */
+static int mmc_read_lba;
+static uintptr_t mmc_read_buf;
+static size_t mmc_read_size;
+static bool mmc_read_data;	/* ops->read() is still to be called */
 
 static const unsigned char tran_speed_base[16] = {
 	0, 10, 12, 13, 15, 20, 26, 30, 35, 40, 45, 52, 55, 60, 70, 80
@@ -481,7 +486,12 @@ static int mmc_enumerate(unsigned int clk, unsigned int bus_width)
 	return mmc_fill_device_info();
 }
 
-size_t mmc_read_blocks(int lba, uintptr_t buf, size_t size)
+/*
+ * Start to read blocks. Drivers which set up a DMA transfer in ops->prepare()
+ * read the data in the background, until mmc_read_blocks_poll() calls
+ * ops->read(). Other drivers read the data in ops->read().
+ */
+int mmc_read_blocks_submit(int lba, uintptr_t buf, size_t size)
 {
 	int ret;
 	unsigned int cmd_idx, cmd_arg;
@@ -489,11 +499,12 @@ size_t mmc_read_blocks(int lba, uintptr_t buf, size_t size)
 	assert((ops != NULL) &&
 	       (ops->read != NULL) &&
 	       (size != 0U) &&
-	       ((size & MMC_BLOCK_MASK) == 0U));
+	       ((size & MMC_BLOCK_MASK) == 0U) &&
+	       (mmc_read_size == 0U));
 
 	ret = ops->prepare(lba, buf, size);
 	if (ret != 0) {
-		return 0;
+		return ret;
 	}
 
 	if (is_cmd23_enabled()) {
@@ -501,7 +512,7 @@ size_t mmc_read_blocks(int lba, uintptr_t buf, size_t size)
 		ret = mmc_send_cmd(MMC_CMD(23), size / MMC_BLOCK_SIZE,
 				   MMC_RESPONSE_R1, NULL);
 		if (ret != 0) {
-			return 0;
+			return ret;
 		}
 
 		cmd_idx = MMC_CMD(18);
@@ -522,30 +533,81 @@ size_t mmc_read_blocks(int lba, uintptr_t buf, size_t size)
 
 	ret = mmc_send_cmd(cmd_idx, cmd_arg, MMC_RESPONSE_R1, NULL);
 	if (ret != 0) {
-		return 0;
+		return ret;
 	}
 
-	ret = ops->read(lba, buf, size);
-	if (ret != 0) {
-		return 0;
+	mmc_read_lba = lba;
+	mmc_read_buf = buf;
+	mmc_read_size = size;
+	mmc_read_data = true;
+
+	return 0;
+}
+
+/*
+ * Complete the read started by mmc_read_blocks_submit(). Returns -EBUSY while
+ * the device is not done with it, but ops->read() usually waits for the end of
+ * the data transfer, after which the buffer must be coherent with the caches.
+ */
+int mmc_read_blocks_poll(size_t *size_read)
+{
+	int ret;
+	size_t size = mmc_read_size;
+
+	assert((size != 0U) && (size_read != NULL));
+
+	if (mmc_read_data) {
+		ret = ops->read(mmc_read_lba, mmc_read_buf, size);
+		mmc_read_data = false;
+		if (ret != 0) {
+			mmc_read_size = 0U;
+			return ret;
+		}
 	}
 
 	/* Wait buffer empty */
-	do {
-		ret = mmc_device_state();
-		if (ret < 0) {
-			return 0;
-		}
-	} while ((ret != MMC_STATE_TRAN) && (ret != MMC_STATE_DATA));
+	ret = mmc_device_state();
+	if ((ret >= 0) &&
+	    (ret != MMC_STATE_TRAN) && (ret != MMC_STATE_DATA)) {
+		return -EBUSY;
+	}
+
+	mmc_read_size = 0U;
+	if (ret < 0) {
+		return ret;
+	}
 
 	if (!is_cmd23_enabled() && (size > MMC_BLOCK_SIZE)) {
 		ret = mmc_send_cmd(MMC_CMD(12), 0, MMC_RESPONSE_R1B, NULL);
 		if (ret != 0) {
-			return 0;
+			return ret;
 		}
 	}
 
-	return size;
+	*size_read = size;
+
+	return 0;
+}
+
+size_t mmc_read_blocks(int lba, uintptr_t buf, size_t size)
+{
+	size_t size_read;
+	int ret;
+
+	ret = mmc_read_blocks_submit(lba, buf, size);
+	if (ret != 0) {
+		return 0;
+	}
+
+	do {
+		ret = mmc_read_blocks_poll(&size_read);
+	} while (ret == -EBUSY);
+
+	if (ret != 0) {
+		return 0;
+	}
+
+	return size_read;
 }
 
 size_t mmc_write_blocks(int lba, const uintptr_t buf, size_t size)
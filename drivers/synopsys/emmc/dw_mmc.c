@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2016-2017, ARM Limited and Contributors. All rights reserved.
+ * Copyright (c) 2016-2018, ARM Limited and Contributors. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  */
@@ -379,6 +379,34 @@ static int dw_prepare(int lba, uintptr_t buf, size_t size)
 
 static int dw_read(int lba, uintptr_t buf, size_t size)
 {
+	unsigned int data, err_mask;
+	int timeout = TIMEOUT;
+
+	/*
+	 * Wait for the end of the data transfer set up by dw_prepare(), which
+	 * the controller signals once the IDMAC has written the last data to
+	 * the buffer. The status is kept until the next command clears it
+	 * (see dw_send_cmd()). Only then drop any line of the buffer the CPU
+	 * may have fetched meanwhile.
+	 */
+	err_mask = INT_EBE | INT_SBE | INT_HLE | INT_FRUN | INT_DRT | INT_DCRC;
+	do {
+		data = mmio_read_32(dw_params.reg_base + DWMMC_RINTSTS);
+		if (data & err_mask) {
+			ERROR("%s, RINTSTS:0x%x\n", __func__, data);
+			return -EIO;
+		}
+		if (data & INT_DTO)
+			break;
+		if (--timeout <= 0) {
+			ERROR("%s, RINTSTS:0x%x\n", __func__, data);
+			panic();
+		}
+		udelay(50);
+	} while (1);
+
+	inv_dcache_range(buf, size);
+
 	return 0;
 }
 
@@ -0,0 +1,95 @@
+/*
+ * Copyright (c) 2018, ARM Limited and Contributors. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef INTR_TRACE_H
+#define INTR_TRACE_H
+
+#include <utils_def.h>
+
+/*
+ * Defines for EL3 interrupt trace SMC function ids.
+ */
+#define INTR_TRACE_SMC_DRAIN		U(0xC2000080)
+#define INTR_TRACE_NUM_SMC_CALLS	1
+
+/*
+ * The macros below are used to identify
+ * EL3 interrupt trace calls from the SMC function ID.
+ */
+#define INTR_TRACE_FID_MASK		U(0xffe0)
+#define INTR_TRACE_FID_VALUE		U(0x80)
+#define is_intr_trace_fid(_fid)		\
+	(((_fid) & INTR_TRACE_FID_MASK) == INTR_TRACE_FID_VALUE)
+
+/* Number of records in the ring of each CPU, a power of 2 */
+#ifndef INTR_TRACE_RING_SIZE
+#define INTR_TRACE_RING_SIZE		U(64)
+#endif
+
+#ifndef __ASSEMBLY__
+
+#include <cassert.h>
+#include <interrupt_mgmt.h>
+#include <stdint.h>
+
+CASSERT(IS_POWER_OF_TWO(INTR_TRACE_RING_SIZE),
+	assert_intr_trace_ring_size_not_power_of_two);
+
+/*
+ * Trace of the handling of one interrupt taken to EL3. Times are CNTPCT
+ * values, 0 if the step did not happen:
+ *   entry:	the exception was taken to EL3
+ *   ack:	the interrupt was acknowledged at the interrupt controller
+ *   dispatch:	the handler of the interrupt was called, i.e. the handler of
+ *		its INTID for the dispatchers which report it (EHF, platforms),
+ *		else the handler of its type
+ *   eoi:	the end of the interrupt was signalled
+ *   exit:	EL3 started to restore the lower EL context to return to it
+ */
+typedef struct intr_trace_rec {
+	uint32_t intr_id;	/* INTR_ID_UNAVAILABLE if not known */
+	uint16_t type;		/* INTR_TYPE_* as reported at entry */
+	uint16_t ns;		/* 1 if the normal world was interrupted */
+	uint64_t entry;
+	uint64_t ack;
+	uint64_t dispatch;
+	uint64_t eoi;
+	uint64_t exit;
+} intr_trace_rec_t;
+
+#if ENABLE_INTR_TRACE && defined(IMAGE_BL31)
+uint32_t intr_trace_begin(uint64_t entry);
+interrupt_type_handler_t intr_trace_get_handler(uint32_t type);
+void intr_trace_ack(uint32_t intr_raw);
+void intr_trace_dispatch(uint32_t intr_id);
+void intr_trace_eoi(void);
+void intr_trace_end(void);
+int intr_trace_drain(unsigned int cpu_idx, intr_trace_rec_t *rec,
+		     uint64_t *lost);
+uintptr_t intr_trace_smc_handler(unsigned int smc_fid,
+			u_register_t x1,
+			u_register_t x2,
+			u_register_t x3,
+			u_register_t x4,
+			void *cookie,
+			void *handle,
+			u_register_t flags);
+#else
+static inline void intr_trace_ack(uint32_t intr_raw)
+{
+}
+
+static inline void intr_trace_dispatch(uint32_t intr_id)
+{
+}
+
+static inline void intr_trace_eoi(void)
+{
+}
+#endif /* ENABLE_INTR_TRACE && defined(IMAGE_BL31) */
+
+#endif /* __ASSEMBLY__ */
+#endif /* INTR_TRACE_H */
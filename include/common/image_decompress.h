@@ -16,9 +16,31 @@ typedef int (decompressor_t)(uintptr_t *in_buf, size_t in_len,
 			     uintptr_t *out_buf, size_t out_len,
 			     uintptr_t work_buf, size_t work_len);
 
+/*
+ * Decompressor fed with the compressed data chunk by chunk, as it is read
+ * from the storage:
+ *   init:	start to decompress into out_buf, using work_buf as workspace
+ *   feed:	decompress the next chunk, in_buf can be reused on return
+ *   finish:	end the decompression, returning the end of output in out_buf
+ */
+typedef struct decompressor_stream {
+	int (*init)(uintptr_t out_buf, size_t out_len,
+		    uintptr_t work_buf, size_t work_len);
+	int (*feed)(uintptr_t in_buf, size_t in_len);
+	int (*finish)(uintptr_t *out_buf);
+} decompressor_stream_t;
+
 void image_decompress_init(uintptr_t buf_base, uint32_t buf_size,
 			   decompressor_t *decompressor);
 void image_decompress_prepare(struct image_info *info);
 int image_decompress(struct image_info *info);
 
+#if IMAGE_DECOMPRESS_STREAM
+void image_decompress_stream_init(uintptr_t buf_base, uint32_t buf_size,
+				  const decompressor_stream_t *stream);
+int image_decompress_is_pending(const struct image_info *info);
+int image_decompress_read(uintptr_t image_handle, size_t image_size,
+			  size_t *bytes_read);
+#endif
+
 #endif /* IMAGE_DECOMPRESS_H */
@@ -31,6 +31,12 @@
 #endif /* AARCH32 */
 #define SIZEOF_RT_SVC_DESC	(U(1) << RT_SVC_SIZE_LOG2)
 
+/*
+ * Constants to allow the assembler access a fast SMC descriptor
+ */
+#define RT_FAST_SMC_DESC_HANDLE	U(8)
+#define SIZEOF_RT_FAST_SMC_DESC	U(16)
+
 
 /*
  * In SMCCC 1.X, the function identifier has 6 bits for the owning entity number
@@ -143,6 +149,46 @@ CASSERT(RT_SVC_DESC_INIT == __builtin_offsetof(rt_svc_desc_t, init), \
 CASSERT(RT_SVC_DESC_HANDLE == __builtin_offsetof(rt_svc_desc_t, handle), \
 	assert_rt_svc_desc_handle_offset_mismatch);
 
+#if SMC_FAST_PATH
+/*
+ * Descriptor of a handler for a single SMC function ID. The EL3 exception
+ * vectors look up the function ID of an SMC from AArch64 in the table of these
+ * descriptors before the runtime service of its owning entity, and call the
+ * handler with only the caller's x0-x18 and SP_EL0 saved in the context.
+ *
+ * The handler is called with the same arguments as a runtime service handler
+ * and must return with the SMC_RETx macros. It must not change the security
+ * state or the return address of the caller, and must not rely on the values
+ * of x19-x29, SPSR_EL3, ELR_EL3 and SCR_EL3 saved in the context, which are not
+ * updated on this path.
+ */
+typedef struct rt_fast_smc_desc {
+	uint32_t smc_fid;
+	rt_svc_handle_t handle;
+} rt_fast_smc_desc_t;
+
+/*
+ * Convenience macro to declare a fast SMC descriptor
+ */
+#define DECLARE_RT_FAST_SMC(_name, _fid, _smch)				\
+	static const rt_fast_smc_desc_t __fast_smc_desc_ ## _name	\
+		__section("rt_fast_smc_descs") __used = {		\
+			.smc_fid = (_fid),				\
+			.handle = (_smch)				\
+		}
+
+/*
+ * Compile time assertions related to the 'rt_fast_smc_desc' structure to
+ * ensure that the assembler and the compiler agree on its size and on the
+ * offset of the handler.
+ */
+CASSERT((sizeof(rt_fast_smc_desc_t) == SIZEOF_RT_FAST_SMC_DESC), \
+	assert_sizeof_rt_fast_smc_desc_mismatch);
+CASSERT(RT_FAST_SMC_DESC_HANDLE == \
+	__builtin_offsetof(rt_fast_smc_desc_t, handle), \
+	assert_rt_fast_smc_desc_handle_offset_mismatch);
+#endif /* SMC_FAST_PATH */
+
 
 #if SMCCC_MAJOR_VERSION == 1
 /*
@@ -193,6 +239,10 @@ uintptr_t handle_runtime_svc(uint32_t smc_fid, void *cookie, void *handle,
 						unsigned int flags);
 IMPORT_SYM(uintptr_t, __RT_SVC_DESCS_START__,		RT_SVC_DESCS_START);
 IMPORT_SYM(uintptr_t, __RT_SVC_DESCS_END__,		RT_SVC_DESCS_END);
+#if SMC_FAST_PATH
+IMPORT_SYM(uintptr_t, __RT_FAST_SMC_DESCS_START__,	RT_FAST_SMC_DESCS_START);
+IMPORT_SYM(uintptr_t, __RT_FAST_SMC_DESCS_END__,	RT_FAST_SMC_DESCS_END);
+#endif
 void init_crash_reporting(void);
 
 extern uint8_t rt_svc_descs_indices[MAX_RT_SVCS];
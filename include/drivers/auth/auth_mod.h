@@ -12,6 +12,7 @@
 #include <auth_common.h>
 #include <cot_def.h>
 #include <img_parser_mod.h>
+#include <stddef.h>
 #include <tbbr_img_def.h>
 
 /*
@@ -37,6 +38,10 @@ int auth_mod_get_parent_id(unsigned int img_id, unsigned int *parent_id);
 int auth_mod_verify_img(unsigned int img_id,
 			void *img_ptr,
 			unsigned int img_len);
+#if AUTH_STREAM_HASH
+int auth_mod_hash_start(unsigned int img_id);
+void auth_mod_hash_update(void *data_ptr, size_t data_len);
+#endif
 
 /* Macro to register a CoT defined as an array of auth_img_desc_t */
 #define REGISTER_COT(_cot) \
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2016, ARM Limited and Contributors. All rights reserved.
+ * Copyright (c) 2016-2018, ARM Limited and Contributors. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  */
@@ -9,10 +9,19 @@
 
 #include <io_storage.h>
 
-/* block devices ops */
+/*
+ * block devices ops
+ *
+ * read_submit and read_poll are optional, for devices which can read in the
+ * background. read_submit starts to read, and read_poll returns -EBUSY until
+ * the read is complete and then 0 and the number of bytes read, or an error.
+ * Only one read can be in progress at a time.
+ */
 typedef struct io_block_ops {
 	size_t	(*read)(int lba, uintptr_t buf, size_t size);
 	size_t	(*write)(int lba, const uintptr_t buf, size_t size);
+	int	(*read_submit)(int lba, uintptr_t buf, size_t size);
+	int	(*read_poll)(size_t *size_read);
 } io_block_ops_t;
 
 typedef struct io_block_dev_spec {
@@ -21,8 +30,18 @@ typedef struct io_block_dev_spec {
 	size_t		block_size;
 } io_block_dev_spec_t;
 
+/*
+ * Bytes read by the block devices: directly into the caller's buffer, or
+ * through the underlying buffer of the device and copied (bounced).
+ */
+typedef struct io_block_stats {
+	unsigned long long	direct;
+	unsigned long long	bounced;
+} io_block_stats_t;
+
 struct io_dev_connector;
 
 int register_io_dev_block(const struct io_dev_connector **dev_con);
+void io_block_get_stats(io_block_stats_t *stats);
 
 #endif /* IO_BLOCK_H */
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2014, ARM Limited and Contributors. All rights reserved.
+ * Copyright (c) 2014-2018, ARM Limited and Contributors. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  */
@@ -11,4 +11,17 @@ struct io_dev_connector;
 
 int register_io_dev_fip(const struct io_dev_connector **dev_con);
 
+#if FIP_TOC_CACHE
+/*
+ * Files looked up in the ToC cache of the FIP driver (hits) and in the ToC on
+ * storage (misses).
+ */
+typedef struct fip_toc_stats {
+	unsigned int	hits;
+	unsigned int	misses;
+} fip_toc_stats_t;
+
+void fip_get_toc_stats(fip_toc_stats_t *stats);
+#endif /* FIP_TOC_CACHE */
+
 #endif /* IO_FIP_H */
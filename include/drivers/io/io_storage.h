@@ -101,4 +101,16 @@ int io_write(uintptr_t handle, const uintptr_t buffer, size_t length,
 int io_close(uintptr_t handle);
 
 
+/*
+ * Asynchronous read, which only some devices support (-ENOTSUP otherwise).
+ * io_read_submit() starts to read up to 'length' bytes, and io_read_poll()
+ * returns -EBUSY until the read is complete and then returns like io_read().
+ * Devices which cannot report progress may instead wait for the read to
+ * complete in io_read_poll(). Only one read can be in progress per handle.
+ */
+int io_read_submit(uintptr_t handle, uintptr_t buffer, size_t length);
+
+int io_read_poll(uintptr_t handle, size_t *length_read);
+
+
 #endif /* IO_STORAGE_H */
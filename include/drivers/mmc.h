@@ -223,6 +223,8 @@ struct mmc_device_info {
 };
 
 size_t mmc_read_blocks(int lba, uintptr_t buf, size_t size);
+int mmc_read_blocks_submit(int lba, uintptr_t buf, size_t size);
+int mmc_read_blocks_poll(size_t *size_read);
 size_t mmc_write_blocks(int lba, const uintptr_t buf, size_t size);
 size_t mmc_erase_blocks(int lba, size_t size);
 size_t mmc_rpmb_read_blocks(int lba, uintptr_t buf, size_t size);
@@ -11,9 +11,16 @@
 
 #define BAKERY_LOCK_MAX_CPUS		PLATFORM_CORE_COUNT
 
+#if BAKERY_LOCK_TICKET
+/* Offset of the 'owner' counter of a ticket lock, in its own cache line */
+#define BAKERY_LOCK_OWNER_OFFSET	CACHE_WRITEBACK_GRANULE
+#endif
+
 #ifndef __ASSEMBLY__
+#include <cassert.h>
 #include <cdefs.h>
 #include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
 #include <utils_def.h>
 
@@ -50,7 +57,24 @@ static inline uint16_t make_bakery_data(unsigned int choosing, unsigned int num)
 /*****************************************************************************
  * External bakery lock interface.
  ****************************************************************************/
-#if USE_COHERENT_MEM
+#if BAKERY_LOCK_TICKET
+/*
+ * Bakery locks are implemented as ticket locks in normal .bss memory
+ *
+ * Each lock takes two cache lines: one for the next ticket to hand out, which
+ * contenders increment atomically, and one for the ticket being served, which
+ * only the lock holder writes.
+ */
+
+typedef struct bakery_lock {
+	volatile uint16_t next __aligned(CACHE_WRITEBACK_GRANULE);
+	volatile uint16_t owner __aligned(CACHE_WRITEBACK_GRANULE);
+} bakery_lock_t;
+
+CASSERT(offsetof(bakery_lock_t, owner) == BAKERY_LOCK_OWNER_OFFSET,
+	assert_bakery_lock_owner_offset_mismatch);
+
+#elif USE_COHERENT_MEM
 /*
  * Bakery locks are stored in coherent memory
  *
@@ -89,13 +113,26 @@ typedef struct bakery_info {
 
 typedef bakery_info_t bakery_lock_t;
 
-#endif /* __USE_COHERENT_MEM__ */
+#endif /* BAKERY_LOCK_TICKET */
 
 static inline void bakery_lock_init(bakery_lock_t *bakery) {}
 void bakery_lock_get(bakery_lock_t *bakery);
 void bakery_lock_release(bakery_lock_t *bakery);
 
+#if ENABLE_LOCK_STATS && defined(IMAGE_BL31)
+/* Account acquisitions in BL31 in the lock statistics (see lock_stat.h) */
+void lock_stat_bakery_get(bakery_lock_t *bakery, const char *name);
+void lock_stat_bakery_release(bakery_lock_t *bakery);
+
+#define bakery_lock_get(_bakery)	lock_stat_bakery_get(_bakery, #_bakery)
+#define bakery_lock_release(_bakery)	lock_stat_bakery_release(_bakery)
+#endif
+
+#if BAKERY_LOCK_TICKET
+#define DEFINE_BAKERY_LOCK(_name) bakery_lock_t _name
+#else
 #define DEFINE_BAKERY_LOCK(_name) bakery_lock_t _name __section("bakery_lock")
+#endif
 
 #define DECLARE_BAKERY_LOCK(_name) extern bakery_lock_t _name
 
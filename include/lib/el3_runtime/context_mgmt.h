@@ -37,6 +37,9 @@ void cm_prepare_el3_exit(uint32_t security_state);
 #ifndef AARCH32
 void cm_el1_sysregs_context_save(uint32_t security_state);
 void cm_el1_sysregs_context_restore(uint32_t security_state);
+#if CTX_EL1_LAZY_SWITCH
+void cm_el1_mmu_sysregs_unused(uint32_t security_state);
+#endif
 void cm_set_elr_el3(uint32_t security_state, uintptr_t entrypoint);
 void cm_set_elr_spsr_el3(uint32_t security_state,
 			uintptr_t entrypoint, uint32_t spsr);
@@ -35,19 +35,70 @@
 #define CPU_DATA_CRASH_BUF_END		CPU_DATA_CRASH_BUF_OFFSET
 #endif
 
-/* cpu_data size is the data size rounded up to the platform cache line size */
-#define CPU_DATA_SIZE			(((CPU_DATA_CRASH_BUF_END + \
-					CACHE_WRITEBACK_GRANULE - 1) / \
-						CACHE_WRITEBACK_GRANULE) * \
-							CACHE_WRITEBACK_GRANULE)
-
 #if ENABLE_RUNTIME_INSTRUMENTATION
 /* Temporary space to store PMF timestamps from assembly code */
 #define CPU_DATA_PMF_TS_COUNT		1
 #define CPU_DATA_PMF_TS0_OFFSET		CPU_DATA_CRASH_BUF_END
 #define CPU_DATA_PMF_TS0_IDX		0
+#define CPU_DATA_PMF_TS_END		(CPU_DATA_PMF_TS0_OFFSET + \
+						(CPU_DATA_PMF_TS_COUNT << 3))
+#else
+#define CPU_DATA_PMF_TS_END		CPU_DATA_CRASH_BUF_END
+#endif
+
+#if ENABLE_SMC_BENCH
+/* CNTPCT at the last entry to EL3 from a lower EL and at the last exit */
+#define CPU_DATA_SMC_BENCH_TS_COUNT	2
+#define CPU_DATA_SMC_BENCH_TS_OFFSET	CPU_DATA_PMF_TS_END
+#define CPU_DATA_SMC_BENCH_ENTRY_IDX	0
+#define CPU_DATA_SMC_BENCH_EXIT_IDX	1
+#define CPU_DATA_SMC_BENCH_ENTRY_OFFSET	(CPU_DATA_SMC_BENCH_TS_OFFSET + \
+					(CPU_DATA_SMC_BENCH_ENTRY_IDX << 3))
+#define CPU_DATA_SMC_BENCH_EXIT_OFFSET	(CPU_DATA_SMC_BENCH_TS_OFFSET + \
+					(CPU_DATA_SMC_BENCH_EXIT_IDX << 3))
+#define CPU_DATA_SMC_BENCH_TS_END	(CPU_DATA_SMC_BENCH_TS_OFFSET + \
+					(CPU_DATA_SMC_BENCH_TS_COUNT << 3))
+#else
+#define CPU_DATA_SMC_BENCH_TS_END	CPU_DATA_PMF_TS_END
+#endif
+
+#if defined(IMAGE_BL31) && EL3_EXCEPTION_HANDLING
+/* Space reserved for the per-cpu data of the EL3 exception handling framework */
+#define CPU_DATA_EHF_OFFSET		CPU_DATA_SMC_BENCH_TS_END
+#define CPU_DATA_EHF_SIZE		8
+#define CPU_DATA_EHF_END		(CPU_DATA_EHF_OFFSET + CPU_DATA_EHF_SIZE)
+#else
+#define CPU_DATA_EHF_END		CPU_DATA_SMC_BENCH_TS_END
 #endif
 
+/* Round up to the platform cache line size */
+#define CPU_DATA_CACHE_LINE_ALIGN(_x)	((((_x) + CACHE_WRITEBACK_GRANULE - 1) / \
+						CACHE_WRITEBACK_GRANULE) * \
+							CACHE_WRITEBACK_GRANULE)
+
+/*
+ * The fields above are only accessed by the CPU owning the cpu_data. The
+ * fields written by one CPU and read by others, or the other way around, start
+ * in the next cache line so that the accesses of other CPUs, e.g. to the PSCI
+ * state during CPU_ON or AFFINITY_INFO, do not steal the cache line holding the
+ * context pointers and timestamps used on every entry to EL3.
+ */
+#define CPU_DATA_PSCI_OFFSET		CPU_DATA_CACHE_LINE_ALIGN(CPU_DATA_EHF_END)
+/* Space reserved for struct psci_cpu_data */
+#define CPU_DATA_PSCI_SIZE		16
+#define CPU_DATA_PSCI_END		(CPU_DATA_PSCI_OFFSET + CPU_DATA_PSCI_SIZE)
+
+#if PLAT_PCPU_DATA_SIZE
+#define CPU_DATA_PLAT_PCPU_OFFSET	CPU_DATA_PSCI_END
+#define CPU_DATA_PLAT_PCPU_END		(CPU_DATA_PLAT_PCPU_OFFSET + \
+						PLAT_PCPU_DATA_SIZE)
+#else
+#define CPU_DATA_PLAT_PCPU_END		CPU_DATA_PSCI_END
+#endif
+
+/* cpu_data size is the data size rounded up to the platform cache line size */
+#define CPU_DATA_SIZE			CPU_DATA_CACHE_LINE_ALIGN(CPU_DATA_PLAT_PCPU_END)
+
 #ifndef __ASSEMBLY__
 
 #include <arch_helpers.h>
@@ -56,15 +107,6 @@
 #include <psci.h>
 #include <stdint.h>
 
-/* Offsets for the cpu_data structure */
-#define CPU_DATA_PSCI_LOCK_OFFSET	__builtin_offsetof\
-		(cpu_data_t, psci_svc_cpu_data.pcpu_bakery_info)
-
-#if PLAT_PCPU_DATA_SIZE
-#define CPU_DATA_PLAT_PCPU_OFFSET	__builtin_offsetof\
-		(cpu_data_t, platform_cpu_data)
-#endif
-
 /*******************************************************************************
  * Function & variable prototypes
  ******************************************************************************/
@@ -76,7 +118,9 @@
  * It is aligned to the cache line boundary to allow efficient concurrent
  * manipulation of these pointers on different cpus
  *
- * TODO: Add other commonly used variables to this (tf_issues#90)
+ * The data only accessed by the owning cpu comes first. The data shared with
+ * other cpus, i.e. the PSCI and platform per-cpu data, starts in a cache line
+ * of its own (see CPU_DATA_PSCI_OFFSET).
  *
  * The data structure and the _cpu_data accessors should not be used directly
  * by components that have per-cpu members. The member access macros should be
@@ -93,12 +137,17 @@ typedef struct cpu_data {
 #if ENABLE_RUNTIME_INSTRUMENTATION
 	uint64_t cpu_data_pmf_ts[CPU_DATA_PMF_TS_COUNT];
 #endif
-	struct psci_cpu_data psci_svc_cpu_data;
-#if PLAT_PCPU_DATA_SIZE
-	uint8_t platform_cpu_data[PLAT_PCPU_DATA_SIZE];
+#if ENABLE_SMC_BENCH
+	uint64_t cpu_data_smc_bench_ts[CPU_DATA_SMC_BENCH_TS_COUNT];
 #endif
 #if defined(IMAGE_BL31) && EL3_EXCEPTION_HANDLING
 	pe_exc_data_t ehf_data;
+#endif
+	struct psci_cpu_data psci_svc_cpu_data
+		__aligned(CACHE_WRITEBACK_GRANULE);
+#if PLAT_PCPU_DATA_SIZE
+	uint8_t platform_cpu_data[PLAT_PCPU_DATA_SIZE]
+		__aligned(CPU_DATA_PSCI_SIZE);
 #endif
 } __aligned(CACHE_WRITEBACK_GRANULE) cpu_data_t;
 
@@ -124,6 +173,34 @@ CASSERT(CPU_DATA_PMF_TS0_OFFSET == __builtin_offsetof
 		assert_cpu_data_pmf_ts0_offset_mismatch);
 #endif
 
+#if ENABLE_SMC_BENCH
+CASSERT(CPU_DATA_SMC_BENCH_TS_OFFSET == __builtin_offsetof
+		(cpu_data_t, cpu_data_smc_bench_ts[0]),
+		assert_cpu_data_smc_bench_ts_offset_mismatch);
+#endif
+
+#if defined(IMAGE_BL31) && EL3_EXCEPTION_HANDLING
+CASSERT(CPU_DATA_EHF_OFFSET == __builtin_offsetof
+		(cpu_data_t, ehf_data),
+		assert_cpu_data_ehf_offset_mismatch);
+
+CASSERT(sizeof(pe_exc_data_t) <= CPU_DATA_EHF_SIZE,
+		assert_cpu_data_ehf_size_mismatch);
+#endif
+
+CASSERT(CPU_DATA_PSCI_OFFSET == __builtin_offsetof
+		(cpu_data_t, psci_svc_cpu_data),
+		assert_cpu_data_psci_offset_mismatch);
+
+CASSERT(sizeof(struct psci_cpu_data) <= CPU_DATA_PSCI_SIZE,
+		assert_cpu_data_psci_size_mismatch);
+
+#if PLAT_PCPU_DATA_SIZE
+CASSERT(CPU_DATA_PLAT_PCPU_OFFSET == __builtin_offsetof
+		(cpu_data_t, platform_cpu_data),
+		assert_cpu_data_plat_pcpu_offset_mismatch);
+#endif
+
 struct cpu_data *_cpu_data_by_index(uint32_t cpu_index);
 
 #ifndef AARCH32
@@ -159,6 +236,33 @@ void init_cpu_ops(void);
 					 &(_cpu_data_by_index(_ix)->_m),  \
 						sizeof(((cpu_data_t *)0)->_m))
 
+/*
+ * Define the accessors of the per-cpu member _m, of type _type, for the
+ * component _comp:
+ *   _comp_get_<_name>() and _comp_set_<_name>() for the current cpu,
+ *   _comp_get_<_name>_by_idx() and _comp_set_<_name>_by_idx() for the cpu
+ *   of the given index.
+ */
+#define DEFINE_CPU_DATA_ACCESSORS(_comp, _name, _type, _m)		\
+static inline _type _comp##_get_##_name(void)				\
+{									\
+	return get_cpu_data(_m);					\
+}									\
+									\
+static inline void _comp##_set_##_name(_type _v)			\
+{									\
+	set_cpu_data(_m, _v);						\
+}									\
+									\
+static inline _type _comp##_get_##_name##_by_idx(int _ix)		\
+{									\
+	return get_cpu_data_by_index((unsigned int)_ix, _m);		\
+}									\
+									\
+static inline void _comp##_set_##_name##_by_idx(int _ix, _type _v)	\
+{									\
+	set_cpu_data_by_index((unsigned int)_ix, _m, _v);		\
+}
 
 #endif /* __ASSEMBLY__ */
 #endif /* CPU_DATA_H */
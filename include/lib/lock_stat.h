@@ -0,0 +1,73 @@
+/*
+ * Copyright (c) 2018, ARM Limited and Contributors. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef LOCK_STAT_H
+#define LOCK_STAT_H
+
+#include <utils_def.h>
+
+/*
+ * Defines for lock statistics SMC function ids.
+ */
+#define LOCK_STAT_SMC_GET		U(0xC2000020)
+#define LOCK_STAT_SMC_DUMP		U(0x82000021)
+#define LOCK_STAT_SMC_RESET		U(0x82000022)
+#define LOCK_STAT_NUM_SMC_CALLS		3
+
+/*
+ * The macros below are used to identify
+ * lock statistics calls from the SMC function ID.
+ */
+#define LOCK_STAT_FID_MASK	U(0xffe0)
+#define LOCK_STAT_FID_VALUE	U(0x20)
+#define is_lock_stat_fid(_fid)	\
+	(((_fid) & LOCK_STAT_FID_MASK) == LOCK_STAT_FID_VALUE)
+
+/* Number of distinct locks tracked for each CPU */
+#ifndef LOCK_STAT_MAX_LOCKS
+#define LOCK_STAT_MAX_LOCKS	16
+#endif
+
+#ifndef __ASSEMBLY__
+
+#include <stdint.h>
+
+/*
+ * Statistics of one lock as seen by one CPU. Times are in CNTPCT ticks.
+ */
+typedef struct lock_stat {
+	uintptr_t lock;		/* Address of the lock, 0 if the slot is free */
+	const char *name;	/* Lock expression at the first call site */
+	uint64_t count;		/* Number of acquisitions */
+	uint64_t spins;		/* Iterations of the wait loops */
+	uint64_t wait_total;
+	uint64_t wait_max;
+	uint64_t hold_total;
+	uint64_t hold_max;
+	uint64_t acquired_at;	/* Time of the current acquisition */
+} lock_stat_t;
+
+#if ENABLE_LOCK_STATS && defined(IMAGE_BL31)
+void lock_stat_spin(void);
+int lock_stat_get(unsigned int cpu_idx, unsigned int slot, lock_stat_t *stat);
+void lock_stat_dump(void);
+void lock_stat_reset(void);
+uintptr_t lock_stat_smc_handler(unsigned int smc_fid,
+			u_register_t x1,
+			u_register_t x2,
+			u_register_t x3,
+			u_register_t x4,
+			void *cookie,
+			void *handle,
+			u_register_t flags);
+#else
+static inline void lock_stat_spin(void)
+{
+}
+#endif /* ENABLE_LOCK_STATS && defined(IMAGE_BL31) */
+
+#endif /* __ASSEMBLY__ */
+#endif /* LOCK_STAT_H */
@@ -295,6 +295,8 @@ typedef struct psci_cpu_data {
 typedef struct plat_psci_ops {
 	void (*cpu_standby)(plat_local_state_t cpu_state);
 	int (*pwr_domain_on)(u_register_t mpidr);
+	int (*pwr_domain_on_batch)(const u_register_t *mpidrs,
+				   unsigned int count, unsigned int *on_mask);
 	void (*pwr_domain_off)(const psci_power_state_t *target_state);
 	void (*pwr_domain_suspend_pwrdown_early)(
 				const psci_power_state_t *target_state);
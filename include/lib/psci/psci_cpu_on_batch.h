@@ -0,0 +1,55 @@
+/*
+ * Copyright (c) 2018, ARM Limited and Contributors. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef PSCI_CPU_ON_BATCH_H
+#define PSCI_CPU_ON_BATCH_H
+
+#include <utils_def.h>
+
+/*
+ * Defines for batch CPU_ON SMC function ids.
+ */
+#define PSCI_CPU_ON_BATCH_SMC		U(0xC2000060)
+#define PSCI_CPU_ON_BATCH_NUM_SMC_CALLS	1
+
+/*
+ * The macros below are used to identify
+ * batch CPU_ON calls from the SMC function ID.
+ */
+#define PSCI_CPU_ON_BATCH_FID_MASK	U(0xffe0)
+#define PSCI_CPU_ON_BATCH_FID_VALUE	U(0x60)
+#define is_psci_cpu_on_batch_fid(_fid)	\
+	(((_fid) & PSCI_CPU_ON_BATCH_FID_MASK) == PSCI_CPU_ON_BATCH_FID_VALUE)
+
+/*
+ * The cpus of a batch share all their affinity levels but Aff0, and are
+ * given by a bitmap of their Aff0 values, like the target list of a GICv3
+ * SGI.
+ */
+#define PSCI_CPU_ON_BATCH_MAX_CPUS	U(16)
+
+#ifndef __ASSEMBLY__
+
+#include <stdint.h>
+
+#if PSCI_CPU_ON_BATCH && defined(IMAGE_BL31)
+int psci_cpu_on_batch(u_register_t mpidr_base,
+		      u_register_t aff0_mask,
+		      uintptr_t entrypoint,
+		      u_register_t context_id,
+		      unsigned int *started);
+uintptr_t psci_cpu_on_batch_smc_handler(unsigned int smc_fid,
+			u_register_t x1,
+			u_register_t x2,
+			u_register_t x3,
+			u_register_t x4,
+			void *cookie,
+			void *handle,
+			u_register_t flags);
+#endif /* PSCI_CPU_ON_BATCH && defined(IMAGE_BL31) */
+
+#endif /* __ASSEMBLY__ */
+#endif /* PSCI_CPU_ON_BATCH_H */
@@ -0,0 +1,88 @@
+/*
+ * Copyright (c) 2018, ARM Limited and Contributors. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef PSCI_STAT_HIST_H
+#define PSCI_STAT_HIST_H
+
+#include <utils_def.h>
+
+/*
+ * Defines for PSCI statistics histograms SMC function ids.
+ */
+#define PSCI_STAT_HIST_SMC_EXPORT	U(0xC2000040)
+#define PSCI_STAT_HIST_SMC_RESET	U(0x82000041)
+#define PSCI_STAT_HIST_NUM_SMC_CALLS	2
+
+/*
+ * The macros below are used to identify
+ * PSCI statistics histograms calls from the SMC function ID.
+ */
+#define PSCI_STAT_HIST_FID_MASK		U(0xffe0)
+#define PSCI_STAT_HIST_FID_VALUE	U(0x40)
+#define is_psci_stat_hist_fid(_fid)	\
+	(((_fid) & PSCI_STAT_HIST_FID_MASK) == PSCI_STAT_HIST_FID_VALUE)
+
+/* Version of the layout of the exported table */
+#define PSCI_STAT_HIST_VERSION		U(1)
+
+/*
+ * Number of log2 buckets of each histogram. Bucket 0 counts the zero values
+ * and bucket n > 0 the values in [2^(n-1), 2^n), the last bucket also counts
+ * all the larger values.
+ */
+#define PSCI_STAT_HIST_BUCKETS		U(32)
+
+#ifndef __ASSEMBLY__
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Statistics of one local power state of the CPU power domain, as seen by one
+ * CPU. Residencies are in microseconds and wakeup latencies, from the exit of
+ * the low power state until the return to the caller, in nanoseconds.
+ */
+typedef struct psci_stat_hist {
+	uint64_t count;
+	uint64_t residency_total;
+	uint64_t wakeups;
+	uint64_t wakeup_total;
+	uint32_t residency[PSCI_STAT_HIST_BUCKETS];
+	uint32_t wakeup[PSCI_STAT_HIST_BUCKETS];
+} psci_stat_hist_t;
+
+/*
+ * Header of the exported table. It is followed by `cpu_count` times
+ * `state_count` psci_stat_hist_t records, ordered by CPU index and then by
+ * the index returned by the `get_pwr_lvl_state_idx` pm hook.
+ */
+typedef struct psci_stat_hist_hdr {
+	uint32_t version;
+	uint32_t cpu_count;
+	uint32_t state_count;
+	uint32_t bucket_count;
+} psci_stat_hist_hdr_t;
+
+/* Size of the exported table for the given numbers of CPUs and states */
+#define PSCI_STAT_HIST_EXPORT_SIZE(_cpus, _states)			\
+	(sizeof(psci_stat_hist_hdr_t) +					\
+	 ((size_t)(_cpus) * (_states) * sizeof(psci_stat_hist_t)))
+
+#if PSCI_STAT_HIST && defined(IMAGE_BL31)
+size_t psci_stat_hist_export(void *buf, size_t size);
+void psci_stat_hist_reset(void);
+uintptr_t psci_stat_hist_smc_handler(unsigned int smc_fid,
+			u_register_t x1,
+			u_register_t x2,
+			u_register_t x3,
+			u_register_t x4,
+			void *cookie,
+			void *handle,
+			u_register_t flags);
+#endif /* PSCI_STAT_HIST && defined(IMAGE_BL31) */
+
+#endif /* __ASSEMBLY__ */
+#endif /* PSCI_STAT_HIST_H */
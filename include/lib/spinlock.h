@@ -17,6 +17,16 @@ typedef struct spinlock {
 
 void spin_lock(spinlock_t *lock);
 void spin_unlock(spinlock_t *lock);
+int spin_trylock(spinlock_t *lock);
+
+#if ENABLE_LOCK_STATS && defined(IMAGE_BL31)
+/* Account acquisitions in BL31 in the lock statistics (see lock_stat.h) */
+void lock_stat_spin_lock(spinlock_t *lock, const char *name);
+void lock_stat_spin_unlock(spinlock_t *lock);
+
+#define spin_lock(_lock)	lock_stat_spin_lock(_lock, #_lock)
+#define spin_unlock(_lock)	lock_stat_spin_unlock(_lock)
+#endif
 
 #else
 
@@ -12,5 +12,9 @@
 
 int gunzip(uintptr_t *in_buf, size_t in_len, uintptr_t *out_buf,
 	   size_t out_len, uintptr_t work_buf, size_t work_len);
+int gunzip_stream_init(uintptr_t out_buf, size_t out_len,
+		       uintptr_t work_buf, size_t work_len);
+int gunzip_stream_feed(uintptr_t in_buf, size_t in_len);
+int gunzip_stream_finish(uintptr_t *out_buf);
 
 #endif /* TF_GUNZIP_H */
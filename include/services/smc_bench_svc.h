@@ -0,0 +1,33 @@
+/*
+ * Copyright (c) 2018, ARM Limited and Contributors. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef SMC_BENCH_SVC_H
+#define SMC_BENCH_SVC_H
+
+#include <utils_def.h>
+
+/*
+ * SMC function IDs of the benchmark service, in the OEM service range.
+ *
+ * SMC_BENCH_NULL does nothing, SMC_BENCH_ECHO returns x1-x7 unchanged and
+ * SMC_BENCH_TOUCH writes to one byte in each cache line of the first x1 bytes
+ * of a buffer in EL3. SMC_BENCH_GET_TS returns, for the previous of these
+ * calls on the calling CPU, the CNTPCT values at entry to the SMC handler of
+ * BL31 (x1), at entry to the service handler (x2) and at the last exit from
+ * EL3 (x3).
+ */
+#define SMC_BENCH_NULL			U(0x83000000)
+#define SMC_BENCH_ECHO			U(0xC3000001)
+#define SMC_BENCH_TOUCH			U(0xC3000002)
+#define SMC_BENCH_GET_TS		U(0xC3000003)
+#define SMC_BENCH_NUM_CALLS		4
+
+/* Size of the buffer written by SMC_BENCH_TOUCH */
+#ifndef SMC_BENCH_BUF_SIZE
+#define SMC_BENCH_BUF_SIZE		U(0x4000)
+#endif
+
+#endif /* SMC_BENCH_SVC_H */
@@ -23,6 +23,10 @@
 #include <sve.h>
 #include <utils.h>
 
+#if CTX_EL1_LAZY_SWITCH
+/* Security states whose payloads do not use the EL1 stage 1 MMU */
+static unsigned int el1_mmu_unused;
+#endif
 
 /*******************************************************************************
  * Context management library initialisation routine. This library is used by
@@ -489,7 +493,18 @@ void cm_el1_sysregs_context_restore(uint32_t security_state)
 	ctx = cm_get_context(security_state);
 	assert(ctx != NULL);
 
+#if CTX_EL1_LAZY_SWITCH
+	/*
+	 * If one of the worlds does not use the MMU registers, those of the
+	 * other world stay live in the hardware across world switches.
+	 */
+	if (el1_mmu_unused != 0U)
+		el1_sysregs_context_restore_no_mmu(get_sysregs_ctx(ctx));
+	else
+		el1_sysregs_context_restore(get_sysregs_ctx(ctx));
+#else
 	el1_sysregs_context_restore(get_sysregs_ctx(ctx));
+#endif
 
 #if IMAGE_BL31
 	if (security_state == SECURE)
@@ -499,6 +514,22 @@ void cm_el1_sysregs_context_restore(uint32_t security_state)
 #endif
 }
 
+#if CTX_EL1_LAZY_SWITCH
+/*******************************************************************************
+ * This function is used by a runtime service to declare that the payload it
+ * runs in the given security state does not use the EL1 stage 1 MMU, i.e. runs
+ * with SCTLR_EL1.M clear. From then on, the EL1 MMU registers are not restored
+ * on world switches, so that those of the other world stay in place. It must
+ * be called before the payload is first entered.
+ ******************************************************************************/
+void cm_el1_mmu_sysregs_unused(uint32_t security_state)
+{
+	assert(sec_state_is_valid(security_state));
+
+	el1_mmu_unused |= U(1) << security_state;
+}
+#endif
+
 /*******************************************************************************
  * This function populates ELR_EL3 member of 'cpu_context' pertaining to the
  * given security state with the given entrypoint
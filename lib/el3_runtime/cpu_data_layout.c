@@ -0,0 +1,51 @@
+/*
+ * Copyright (c) 2018, ARM Limited and Contributors. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+/*
+ * This file is not linked into any image. It is compiled to assembly with the
+ * flags of BL31 to report the layout of cpu_data_t (see bl31/bl31.mk): each
+ * REPORT() emits a "->" line holding the name, offset, size and cache line of
+ * a member, which the build extracts from the generated assembly.
+ */
+
+#include <cpu_data.h>
+#include <stddef.h>
+
+#define REPORT(_name, _off, _size)					\
+	__asm__ volatile("\n.ascii \"->" #_name " %c0 %c1 %c2\""	\
+			 : : "i" (_off), "i" (_size),			\
+			     "i" ((_off) / CACHE_WRITEBACK_GRANULE))
+
+#define REPORT_MEMBER(_m)						\
+	REPORT(_m, offsetof(cpu_data_t, _m), sizeof(((cpu_data_t *)0)->_m))
+
+void cpu_data_layout(void);
+
+void cpu_data_layout(void)
+{
+#ifndef AARCH32
+	REPORT_MEMBER(cpu_context);
+#endif
+	REPORT_MEMBER(cpu_ops_ptr);
+#if CRASH_REPORTING
+	REPORT_MEMBER(crash_buf);
+#endif
+#if ENABLE_RUNTIME_INSTRUMENTATION
+	REPORT_MEMBER(cpu_data_pmf_ts);
+#endif
+#if ENABLE_SMC_BENCH
+	REPORT_MEMBER(cpu_data_smc_bench_ts);
+#endif
+#if defined(IMAGE_BL31) && EL3_EXCEPTION_HANDLING
+	REPORT_MEMBER(ehf_data);
+#endif
+	REPORT_MEMBER(psci_svc_cpu_data);
+#if PLAT_PCPU_DATA_SIZE
+	REPORT_MEMBER(platform_cpu_data);
+#endif
+	REPORT(cpu_data_t, 0, sizeof(cpu_data_t));
+	REPORT(percpu_data, 0, sizeof(percpu_data));
+}
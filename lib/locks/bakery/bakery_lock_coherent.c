@@ -8,6 +8,7 @@
 #include <assert.h>
 #include <bakery_lock.h>
 #include <cpu_data.h>
+#include <lock_stat.h>
 #include <platform.h>
 #include <string.h>
 
@@ -87,8 +88,11 @@ static unsigned int bakery_get_ticket(bakery_lock_t *bakery, unsigned int me)
  * (and priority) value as 0. The contending CPU compares its priority with that
  * of others'. The CPU with the highest priority (lowest numerical value)
  * acquires the lock
+ *
+ * The name is parenthesised so that the lock statistics wrapper of
+ * bakery_lock.h does not apply.
  */
-void bakery_lock_get(bakery_lock_t *bakery)
+void (bakery_lock_get)(bakery_lock_t *bakery)
 {
 	unsigned int they, me;
 	unsigned int my_ticket, my_prio, their_ticket;
@@ -130,6 +134,7 @@ void bakery_lock_get(bakery_lock_t *bakery)
 			 */
 			do {
 				wfe();
+				lock_stat_spin();
 			} while (their_ticket ==
 				bakery_ticket_number(bakery->lock_data[they]));
 		}
@@ -144,7 +149,7 @@ void bakery_lock_get(bakery_lock_t *bakery)
 
 
 /* Release the lock and signal contenders */
-void bakery_lock_release(bakery_lock_t *bakery)
+void (bakery_lock_release)(bakery_lock_t *bakery)
 {
 	unsigned int me = plat_my_core_pos();
 
@@ -8,6 +8,7 @@
 #include <assert.h>
 #include <bakery_lock.h>
 #include <cpu_data.h>
+#include <lock_stat.h>
 #include <platform.h>
 #include <string.h>
 #include <utils_def.h>
@@ -156,7 +157,11 @@ static unsigned int bakery_get_ticket(bakery_lock_t *lock,
 	return my_ticket;
 }
 
-void bakery_lock_get(bakery_lock_t *lock)
+/*
+ * The names are parenthesised so that the lock statistics wrappers of
+ * bakery_lock.h do not apply.
+ */
+void (bakery_lock_get)(bakery_lock_t *lock)
 {
 	unsigned int they, me, is_cached;
 	unsigned int my_ticket, my_prio, their_ticket;
@@ -209,6 +214,7 @@ void bakery_lock_get(bakery_lock_t *lock)
 			 */
 			do {
 				wfe();
+				lock_stat_spin();
 				read_cache_op((uintptr_t)their_bakery_info, is_cached);
 			} while (their_ticket
 				== bakery_ticket_number(their_bakery_info->lock_data));
@@ -222,7 +228,7 @@ void bakery_lock_get(bakery_lock_t *lock)
 	dmbld();
 }
 
-void bakery_lock_release(bakery_lock_t *lock)
+void (bakery_lock_release)(bakery_lock_t *lock)
 {
 	bakery_info_t *my_bakery_info;
 #ifdef AARCH32
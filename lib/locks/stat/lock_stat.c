@@ -0,0 +1,252 @@
+/*
+ * Copyright (c) 2018, ARM Limited and Contributors. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <arch.h>
+#include <arch_helpers.h>
+#include <bakery_lock.h>
+#include <errno.h>
+#include <lock_stat.h>
+#include <platform.h>
+#include <platform_def.h>
+#include <spinlock.h>
+#include <stdio.h>
+#include <string.h>
+
+/*
+ * Lock statistics are kept per CPU: a CPU only writes its own statistics, so
+ * no further synchronisation is needed to update them. Each CPU tracks up to
+ * LOCK_STAT_MAX_LOCKS distinct locks, identified by their address, in the
+ * order it first acquires them. Further locks are not accounted.
+ *
+ * Locks are also taken and released on the power up and down paths with the
+ * data cache disabled. The statistics of the CPU are then cleaned and
+ * invalidated around the update, so that the update neither starts from stale
+ * memory nor is later overwritten by a stale cached copy.
+ */
+typedef struct lock_stat_cpu {
+	lock_stat_t locks[LOCK_STAT_MAX_LOCKS];
+	unsigned int spins;	/* Wait loop iterations of this acquisition */
+	unsigned int gen;	/* Value of lock_stat_gen at the last reset */
+} __aligned(CACHE_WRITEBACK_GRANULE) lock_stat_cpu_t;
+
+static lock_stat_cpu_t lock_stat_cpus[PLATFORM_CORE_COUNT];
+
+/* Incremented to reset the statistics, which each CPU then does lazily */
+static volatile unsigned int lock_stat_gen;
+
+static unsigned int lock_stat_is_cached(void)
+{
+#ifdef AARCH32
+	return read_sctlr() & SCTLR_C_BIT;
+#else
+	return read_sctlr_el3() & SCTLR_C_BIT;
+#endif
+}
+
+static lock_stat_cpu_t *lock_stat_begin(unsigned int is_cached)
+{
+	lock_stat_cpu_t *cpu = &lock_stat_cpus[plat_my_core_pos()];
+	unsigned int gen = lock_stat_gen;
+
+	if (is_cached == 0U)
+		flush_dcache_range((uintptr_t)cpu, sizeof(*cpu));
+
+	if (cpu->gen != gen) {
+		(void)memset(cpu->locks, 0, sizeof(cpu->locks));
+		cpu->gen = gen;
+	}
+
+	cpu->spins = 0U;
+
+	return cpu;
+}
+
+static void lock_stat_end(lock_stat_cpu_t *cpu, unsigned int is_cached)
+{
+	if (is_cached == 0U)
+		flush_dcache_range((uintptr_t)cpu, sizeof(*cpu));
+}
+
+/*
+ * Find the statistics of a lock. If the lock is not tracked yet and a name is
+ * given, allocate a free slot for it.
+ */
+static lock_stat_t *lock_stat_find(lock_stat_cpu_t *cpu, uintptr_t lock,
+				   const char *name)
+{
+	unsigned int i;
+	lock_stat_t *stat;
+
+	for (i = 0U; i < LOCK_STAT_MAX_LOCKS; i++) {
+		stat = &cpu->locks[i];
+
+		if (stat->lock == lock)
+			return stat;
+
+		if (stat->lock == 0U) {
+			if (name == NULL)
+				return NULL;
+
+			stat->lock = lock;
+			stat->name = name;
+			return stat;
+		}
+	}
+
+	return NULL;
+}
+
+static void lock_stat_acquired(lock_stat_cpu_t *cpu, uintptr_t lock,
+			       const char *name, uint64_t start)
+{
+	uint64_t now = read_cntpct_el0();
+	uint64_t wait = now - start;
+	lock_stat_t *stat = lock_stat_find(cpu, lock, name);
+
+	if (stat == NULL)
+		return;
+
+	stat->count++;
+	stat->spins += cpu->spins;
+	stat->wait_total += wait;
+	if (wait > stat->wait_max)
+		stat->wait_max = wait;
+	stat->acquired_at = now;
+}
+
+static void lock_stat_released(lock_stat_cpu_t *cpu, uintptr_t lock)
+{
+	lock_stat_t *stat = lock_stat_find(cpu, lock, NULL);
+	uint64_t hold;
+
+	/* Not tracked, or acquired before the last reset */
+	if ((stat == NULL) || (stat->acquired_at == 0U))
+		return;
+
+	hold = read_cntpct_el0() - stat->acquired_at;
+	stat->hold_total += hold;
+	if (hold > stat->hold_max)
+		stat->hold_max = hold;
+	stat->acquired_at = 0U;
+}
+
+/*
+ * Called by the bakery lock implementations for each iteration of their wait
+ * loops.
+ */
+void lock_stat_spin(void)
+{
+	lock_stat_cpus[plat_my_core_pos()].spins++;
+}
+
+void lock_stat_spin_lock(spinlock_t *lock, const char *name)
+{
+	unsigned int is_cached = lock_stat_is_cached();
+	lock_stat_cpu_t *cpu = lock_stat_begin(is_cached);
+	uint64_t start = read_cntpct_el0();
+
+	/*
+	 * A failed attempt leaves the lock in the monitor (or the unlock issues
+	 * an SEV), so the next unlock wakes us up from WFE.
+	 */
+	while (spin_trylock(lock) == 0) {
+		wfe();
+		cpu->spins++;
+	}
+
+	lock_stat_acquired(cpu, (uintptr_t)lock, name, start);
+	lock_stat_end(cpu, is_cached);
+}
+
+void lock_stat_spin_unlock(spinlock_t *lock)
+{
+	unsigned int is_cached = lock_stat_is_cached();
+	lock_stat_cpu_t *cpu = lock_stat_begin(is_cached);
+
+	lock_stat_released(cpu, (uintptr_t)lock);
+	lock_stat_end(cpu, is_cached);
+
+	(spin_unlock)(lock);
+}
+
+void lock_stat_bakery_get(bakery_lock_t *bakery, const char *name)
+{
+	unsigned int is_cached = lock_stat_is_cached();
+	lock_stat_cpu_t *cpu = lock_stat_begin(is_cached);
+	uint64_t start = read_cntpct_el0();
+
+	(bakery_lock_get)(bakery);
+
+	lock_stat_acquired(cpu, (uintptr_t)bakery, name, start);
+	lock_stat_end(cpu, is_cached);
+}
+
+void lock_stat_bakery_release(bakery_lock_t *bakery)
+{
+	unsigned int is_cached = lock_stat_is_cached();
+	lock_stat_cpu_t *cpu = lock_stat_begin(is_cached);
+
+	lock_stat_released(cpu, (uintptr_t)bakery);
+	lock_stat_end(cpu, is_cached);
+
+	(bakery_lock_release)(bakery);
+}
+
+/*
+ * Copy the statistics in a slot of a CPU. A free slot reads as all zeros, and
+ * all slots after it are free too. The statistics of other CPUs may be in
+ * the middle of an update.
+ */
+int lock_stat_get(unsigned int cpu_idx, unsigned int slot, lock_stat_t *stat)
+{
+	const lock_stat_cpu_t *cpu;
+
+	if ((cpu_idx >= PLATFORM_CORE_COUNT) || (slot >= LOCK_STAT_MAX_LOCKS))
+		return -EINVAL;
+
+	cpu = &lock_stat_cpus[cpu_idx];
+	if (cpu->gen != lock_stat_gen)
+		(void)memset(stat, 0, sizeof(*stat));
+	else
+		*stat = cpu->locks[slot];
+
+	return 0;
+}
+
+/* Print the statistics of all CPUs on the console */
+void lock_stat_dump(void)
+{
+	unsigned int cpu_idx, slot;
+	lock_stat_t stat;
+
+	printf("Lock statistics (times in counter ticks, %u Hz):\n",
+	       (unsigned int)read_cntfrq_el0());
+
+	for (cpu_idx = 0U; cpu_idx < PLATFORM_CORE_COUNT; cpu_idx++) {
+		for (slot = 0U; slot < LOCK_STAT_MAX_LOCKS; slot++) {
+			(void)lock_stat_get(cpu_idx, slot, &stat);
+			if (stat.lock == 0U)
+				break;
+
+			printf("cpu%u %p %s: count %llu spins %llu"
+			       " wait %llu/%llu hold %llu/%llu (total/max)\n",
+			       cpu_idx, (void *)stat.lock, stat.name,
+			       stat.count, stat.spins,
+			       stat.wait_total, stat.wait_max,
+			       stat.hold_total, stat.hold_max);
+		}
+	}
+}
+
+/*
+ * Reset the statistics of all CPUs. Each CPU clears its own statistics on its
+ * next lock operation.
+ */
+void lock_stat_reset(void)
+{
+	lock_stat_gen++;
+	flush_dcache_range((uintptr_t)&lock_stat_gen, sizeof(lock_stat_gen));
+}
@@ -0,0 +1,59 @@
+/*
+ * Copyright (c) 2018, ARM Limited and Contributors. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <debug.h>
+#include <lock_stat.h>
+#include <smccc_helpers.h>
+
+/*
+ * This function is responsible for handling all lock statistics SMC calls.
+ */
+uintptr_t lock_stat_smc_handler(unsigned int smc_fid,
+			u_register_t x1,
+			u_register_t x2,
+			u_register_t x3,
+			u_register_t x4,
+			void *cookie,
+			void *handle,
+			u_register_t flags)
+{
+	int rc;
+	lock_stat_t stat;
+
+	switch (smc_fid) {
+	case LOCK_STAT_SMC_GET:
+		/*
+		 * Return the statistics of one lock to the caller.
+		 * x1 --> CPU index, x2 --> slot, from 0 until the lock
+		 * address reads as 0.
+		 * x0 --> error code.
+		 * x1 --> lock address.
+		 * x2 - x7 --> count, spins, total and max wait time, total and
+		 * max hold time, in counter ticks.
+		 */
+		rc = lock_stat_get((unsigned int)x1, (unsigned int)x2, &stat);
+		if (rc != 0)
+			SMC_RET1(handle, rc);
+
+		SMC_RET8(handle, rc, stat.lock, stat.count, stat.spins,
+			 stat.wait_total, stat.wait_max,
+			 stat.hold_total, stat.hold_max);
+
+	case LOCK_STAT_SMC_DUMP:
+		lock_stat_dump();
+		SMC_RET1(handle, SMC_OK);
+
+	case LOCK_STAT_SMC_RESET:
+		lock_stat_reset();
+		SMC_RET1(handle, SMC_OK);
+
+	default:
+		break;
+	}
+
+	WARN("Unimplemented lock statistics Call: 0x%x \n", smc_fid);
+	SMC_RET1(handle, SMC_UNK);
+}
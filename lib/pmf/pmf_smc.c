@@ -7,6 +7,7 @@
 #include <debug.h>
 #include <platform.h>
 #include <pmf.h>
+#include <runtime_svc.h>
 #include <smccc_helpers.h>
 
 /*
@@ -59,3 +60,11 @@ uintptr_t pmf_smc_handler(unsigned int smc_fid,
 	WARN("Unimplemented PMF Call: 0x%x \n", smc_fid);
 	SMC_RET1(handle, SMC_UNK);
 }
+
+#if SMC_FAST_PATH
+/* Let timestamp queries skip the SiP service dispatch */
+DECLARE_RT_FAST_SMC(pmf_get_timestamp_32, PMF_SMC_GET_TIMESTAMP_32,
+		    pmf_smc_handler);
+DECLARE_RT_FAST_SMC(pmf_get_timestamp_64, PMF_SMC_GET_TIMESTAMP_64,
+		    pmf_smc_handler);
+#endif
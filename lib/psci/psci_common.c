@@ -41,6 +41,23 @@ const spd_pm_ops_t *psci_spd_pm;
 static plat_local_state_t
 	psci_req_local_pwr_states[PLAT_MAX_PWR_LVL][PLATFORM_CORE_COUNT];
 
+#if PSCI_COORD_COUNTERS
+/*
+ * Summary of the requested local power states of each non cpu power domain:
+ * the number of cpus within the domain requesting each local power state.
+ * It is updated along with psci_req_local_pwr_states, under the lock of the
+ * power domain, and lets state coordination find the shallowest requested
+ * state of a domain without scanning the states requested by each of its
+ * cpus. The counters of each domain are in their own cache line.
+ */
+typedef struct psci_req_state_count {
+	unsigned short count[PLAT_MAX_OFF_STATE + 1U];
+} __aligned(CACHE_WRITEBACK_GRANULE) psci_req_state_count_t;
+
+static psci_req_state_count_t
+	psci_req_state_counts[PSCI_NUM_NON_CPU_PWR_DOMAINS];
+#endif
+
 
 /*******************************************************************************
  * Arrays that hold the platform's power domain tree information for state
@@ -185,7 +202,8 @@ static unsigned int get_power_on_target_pwrlvl(void)
 	 * Assume that this cpu was suspended and retrieve its target power
 	 * level. If it is invalid then it could only have been turned off
 	 * earlier. PLAT_MAX_PWR_LVL will be the highest power level a
-	 * cpu can be turned off to.
+	 * cpu can be turned off to. A cpu turned on by a batch CPU_ON may
+	 * also have the CPU level set by psci_cpu_on_precoordinate().
 	 */
 	pwrlvl = psci_get_suspend_pwrlvl();
 	if (pwrlvl == PSCI_INVALID_PWR_LVL)
@@ -196,12 +214,19 @@ static unsigned int get_power_on_target_pwrlvl(void)
 /******************************************************************************
  * Helper function to update the requested local power state array. This array
  * does not store the requested state for the CPU power level. Hence an
- * assertion is added to prevent us from accessing the wrong index.
+ * assertion is added to prevent us from accessing the wrong index. The
+ * 'parent_idx' is the ancestor of the cpu at 'pwrlvl'.
  *****************************************************************************/
 static void psci_set_req_local_pwr_state(unsigned int pwrlvl,
 					 unsigned int cpu_idx,
+					 unsigned int parent_idx,
 					 plat_local_state_t req_pwr_state)
 {
+#if PSCI_COORD_COUNTERS
+	plat_local_state_t prev_pwr_state;
+	psci_req_state_count_t *req_count = &psci_req_state_counts[parent_idx];
+#endif
+
 	/*
 	 * This should never happen, we have this here to avoid
 	 * "array subscript is above array bounds" errors in GCC.
@@ -209,9 +234,40 @@ static void psci_set_req_local_pwr_state(unsigned int pwrlvl,
 	assert(pwrlvl > PSCI_CPU_PWR_LVL);
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Warray-bounds"
+#if PSCI_COORD_COUNTERS
+	prev_pwr_state = psci_req_local_pwr_states[pwrlvl - 1U][cpu_idx];
+#endif
 	psci_req_local_pwr_states[pwrlvl - 1U][cpu_idx] = req_pwr_state;
 #pragma GCC diagnostic pop
+
+#if PSCI_COORD_COUNTERS
+	assert(req_pwr_state <= PLAT_MAX_OFF_STATE);
+	assert(req_count->count[prev_pwr_state] > 0U);
+	req_count->count[prev_pwr_state]--;
+	req_count->count[req_pwr_state]++;
+#endif
+}
+
+#if PSCI_COORD_COUNTERS
+/******************************************************************************
+ * Helper function to return the shallowest local power state requested by the
+ * cpus within a non cpu power domain. This is the coordinated target state of
+ * the default plat_get_target_pwr_state(), found in constant time.
+ *****************************************************************************/
+static plat_local_state_t psci_get_coord_target_state(unsigned int parent_idx)
+{
+	const psci_req_state_count_t *req_count =
+		&psci_req_state_counts[parent_idx];
+	unsigned int state;
+
+	for (state = 0U; state < PLAT_MAX_OFF_STATE; state++) {
+		if (req_count->count[state] != 0U)
+			break;
+	}
+
+	return (plat_local_state_t)state;
 }
+#endif
 
 /******************************************************************************
  * This function initializes the psci_req_local_pwr_states.
@@ -221,6 +277,9 @@ void __init psci_init_req_local_pwr_states(void)
 	/* Initialize the requested state of all non CPU power domains as OFF */
 	unsigned int pwrlvl;
 	int core;
+#if PSCI_COORD_COUNTERS
+	unsigned int node;
+#endif
 
 	for (pwrlvl = 0U; pwrlvl < PLAT_MAX_PWR_LVL; pwrlvl++) {
 		for (core = 0; core < PLATFORM_CORE_COUNT; core++) {
@@ -228,6 +287,14 @@ void __init psci_init_req_local_pwr_states(void)
 				PLAT_MAX_OFF_STATE;
 		}
 	}
+
+#if PSCI_COORD_COUNTERS
+	/* All the cpus within each domain request the OFF state */
+	for (node = 0U; node < PSCI_NUM_NON_CPU_PWR_DOMAINS; node++) {
+		psci_req_state_counts[node].count[PLAT_MAX_OFF_STATE] =
+			(unsigned short)psci_non_cpu_pd_nodes[node].ncpus;
+	}
+#endif
 }
 
 /******************************************************************************
@@ -380,6 +447,7 @@ void psci_set_pwr_domains_to_run(unsigned int end_pwrlvl)
 				PSCI_LOCAL_STATE_RUN);
 		psci_set_req_local_pwr_state(lvl,
 					     cpu_idx,
+					     parent_idx,
 					     PSCI_LOCAL_STATE_RUN);
 		parent_idx = psci_non_cpu_pd_nodes[parent_idx].parent_node;
 	}
@@ -405,6 +473,10 @@ void psci_set_pwr_domains_to_run(unsigned int end_pwrlvl)
  * coordination is not required. Hence, the requested and the target states are
  * the same.
  *
+ * With PSCI_COORD_COUNTERS, the target state of each level is instead found
+ * from the summary counters of the power domain, which implement the policy of
+ * the default plat_get_target_pwr_state(), so the platform is not called.
+ *
  * The 'state_info' is updated with the target state for each level between the
  * CPU and the 'end_pwrlvl' and returned to the caller.
  *
@@ -415,9 +487,12 @@ void psci_do_state_coordination(unsigned int end_pwrlvl,
 				psci_power_state_t *state_info)
 {
 	unsigned int lvl, parent_idx, cpu_idx = plat_my_core_pos();
+#if !PSCI_COORD_COUNTERS
 	int start_idx;
 	unsigned int ncpus;
-	plat_local_state_t target_state, *req_states;
+	plat_local_state_t *req_states;
+#endif
+	plat_local_state_t target_state;
 
 	assert(end_pwrlvl <= PLAT_MAX_PWR_LVL);
 	parent_idx = psci_cpu_pd_nodes[cpu_idx].parent_node;
@@ -427,9 +502,17 @@ void psci_do_state_coordination(unsigned int end_pwrlvl,
 	for (lvl = PSCI_CPU_PWR_LVL + 1U; lvl <= end_pwrlvl; lvl++) {
 
 		/* First update the requested power state */
-		psci_set_req_local_pwr_state(lvl, cpu_idx,
+		psci_set_req_local_pwr_state(lvl, cpu_idx, parent_idx,
 					     state_info->pwr_domain_state[lvl]);
 
+#if PSCI_COORD_COUNTERS
+		/*
+		 * The requested states of this power domain are summarised in
+		 * its counters, so the target state is the shallowest state
+		 * with a non-zero count.
+		 */
+		target_state = psci_get_coord_target_state(parent_idx);
+#else
 		/* Get the requested power states for this power level */
 		start_idx = psci_non_cpu_pd_nodes[parent_idx].cpu_start_idx;
 		req_states = psci_get_req_local_pwr_states(lvl, start_idx);
@@ -442,6 +525,7 @@ void psci_do_state_coordination(unsigned int end_pwrlvl,
 		target_state = plat_get_target_pwr_state(lvl,
 							 req_states,
 							 ncpus);
+#endif
 
 		state_info->pwr_domain_state[lvl] = target_state;
 
@@ -459,7 +543,8 @@ void psci_do_state_coordination(unsigned int end_pwrlvl,
 	 * set the target state as RUN.
 	 */
 	for (lvl = lvl + 1U; lvl <= end_pwrlvl; lvl++) {
-		psci_set_req_local_pwr_state(lvl, cpu_idx,
+		parent_idx = psci_non_cpu_pd_nodes[parent_idx].parent_node;
+		psci_set_req_local_pwr_state(lvl, cpu_idx, parent_idx,
 					     state_info->pwr_domain_state[lvl]);
 		state_info->pwr_domain_state[lvl] = PSCI_LOCAL_STATE_RUN;
 
@@ -549,6 +634,79 @@ unsigned int psci_find_max_off_lvl(const psci_power_state_t *state_info)
 	return PSCI_INVALID_PWR_LVL;
 }
 
+#if PSCI_CPU_ON_BATCH
+/******************************************************************************
+ * This function is called with the cpu lock of `cpu_idx` held, before the cpu
+ * is powered on by a batch CPU_ON. If all the ancestor power domains of the
+ * cpu are running, it sets the requested local state of the cpu to RUN for
+ * each of them, which keeps them running until the cpu powers down again.
+ * The cpu then has no power domain state above its own to manage when it
+ * wakes up, so its target power level is set to the CPU level to let it skip
+ * the power domain locks on the warm boot path. It returns true in that case.
+ *****************************************************************************/
+bool psci_cpu_on_precoordinate(int cpu_idx)
+{
+	unsigned int parent_idx, lvl;
+	bool running = true;
+
+	psci_acquire_pwr_domain_locks(PLAT_MAX_PWR_LVL, cpu_idx);
+
+	parent_idx = psci_cpu_pd_nodes[cpu_idx].parent_node;
+	for (lvl = PSCI_CPU_PWR_LVL + 1U; lvl <= PLAT_MAX_PWR_LVL; lvl++) {
+		if (is_local_state_run(
+			get_non_cpu_pd_node_local_state(parent_idx)) == 0) {
+			running = false;
+			break;
+		}
+		parent_idx = psci_non_cpu_pd_nodes[parent_idx].parent_node;
+	}
+
+	if (running) {
+		parent_idx = psci_cpu_pd_nodes[cpu_idx].parent_node;
+		for (lvl = PSCI_CPU_PWR_LVL + 1U; lvl <= PLAT_MAX_PWR_LVL;
+		     lvl++) {
+			psci_set_req_local_pwr_state(lvl, (unsigned int)cpu_idx,
+					parent_idx, PSCI_LOCAL_STATE_RUN);
+			parent_idx =
+				psci_non_cpu_pd_nodes[parent_idx].parent_node;
+		}
+
+		/* Read on the warm boot path with the data cache disabled */
+		psci_set_suspend_pwrlvl_by_idx(cpu_idx, PSCI_CPU_PWR_LVL);
+		flush_cpu_data_by_index((unsigned int)cpu_idx,
+					psci_svc_cpu_data.target_pwrlvl);
+	}
+
+	psci_release_pwr_domain_locks(PLAT_MAX_PWR_LVL, cpu_idx);
+
+	return running;
+}
+
+/******************************************************************************
+ * This function reverts psci_cpu_on_precoordinate() for a cpu that could not
+ * be powered on, which still requests the OFF state it powered down to.
+ *****************************************************************************/
+void psci_cpu_on_precoordinate_revert(int cpu_idx)
+{
+	unsigned int parent_idx, lvl;
+
+	psci_acquire_pwr_domain_locks(PLAT_MAX_PWR_LVL, cpu_idx);
+
+	parent_idx = psci_cpu_pd_nodes[cpu_idx].parent_node;
+	for (lvl = PSCI_CPU_PWR_LVL + 1U; lvl <= PLAT_MAX_PWR_LVL; lvl++) {
+		psci_set_req_local_pwr_state(lvl, (unsigned int)cpu_idx,
+				parent_idx, PLAT_MAX_OFF_STATE);
+		parent_idx = psci_non_cpu_pd_nodes[parent_idx].parent_node;
+	}
+
+	psci_set_suspend_pwrlvl_by_idx(cpu_idx, PSCI_INVALID_PWR_LVL);
+	flush_cpu_data_by_index((unsigned int)cpu_idx,
+				psci_svc_cpu_data.target_pwrlvl);
+
+	psci_release_pwr_domain_locks(PLAT_MAX_PWR_LVL, cpu_idx);
+}
+#endif /* PSCI_CPU_ON_BATCH */
+
 /******************************************************************************
  * This functions finds the level of the highest power domain which will be
  * placed in a low power state during a suspend operation.
@@ -763,6 +921,7 @@ void psci_warmboot_entrypoint(void)
 	unsigned int end_pwrlvl;
 	int cpu_idx = (int) plat_my_core_pos();
 	psci_power_state_t state_info = { {PSCI_LOCAL_STATE_RUN} };
+	bool is_suspend;
 
 	/*
 	 * Verify that we have been explicitly turned ON or resumed from
@@ -804,10 +963,11 @@ void psci_warmboot_entrypoint(void)
 	 * of power management handler and perform the generic, architecture
 	 * and platform specific handling.
 	 */
-	if (psci_get_aff_info_state() == AFF_STATE_ON_PENDING)
-		psci_cpu_on_finish(cpu_idx, &state_info);
-	else
+	is_suspend = (psci_get_aff_info_state() != AFF_STATE_ON_PENDING);
+	if (is_suspend)
 		psci_cpu_suspend_finish(cpu_idx, &state_info);
+	else
+		psci_cpu_on_finish(cpu_idx, &state_info);
 
 	/*
 	 * Set the requested and target state of this CPU and all the higher
@@ -830,6 +990,16 @@ void psci_warmboot_entrypoint(void)
 	 * in the reverse order to which they were acquired.
 	 */
 	psci_release_pwr_domain_locks(end_pwrlvl, cpu_idx);
+
+#if PSCI_STAT_HIST
+	/*
+	 * The CPU returns to the caller of CPU_SUSPEND right after this, so
+	 * this is the end of its wakeup. A CPU that has just been turned on
+	 * has no caller to return to.
+	 */
+	if (is_suspend)
+		psci_stats_update_wakeup(psci_stats_warmboot_wake_ts());
+#endif
 }
 
 /*******************************************************************************
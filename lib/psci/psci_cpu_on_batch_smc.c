@@ -0,0 +1,51 @@
+/*
+ * Copyright (c) 2018, ARM Limited and Contributors. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <debug.h>
+#include <psci.h>
+#include <psci_cpu_on_batch.h>
+#include <smccc_helpers.h>
+
+/*
+ * This function is responsible for handling all batch CPU_ON SMC calls.
+ */
+uintptr_t psci_cpu_on_batch_smc_handler(unsigned int smc_fid,
+			u_register_t x1,
+			u_register_t x2,
+			u_register_t x3,
+			u_register_t x4,
+			void *cookie,
+			void *handle,
+			u_register_t flags)
+{
+	int rc;
+	unsigned int started;
+
+	/* Like the PSCI calls, this is only available to the normal world */
+	if (is_caller_secure(flags))
+		SMC_RET1(handle, SMC_UNK);
+
+	switch (smc_fid) {
+	case PSCI_CPU_ON_BATCH_SMC:
+		/*
+		 * Turn on a set of cpus sharing their affinity above Aff0.
+		 * x1 --> mpidr of the cpus, with Aff0 set to 0.
+		 * x2 --> bitmap of the Aff0 values of the cpus.
+		 * x3 --> entry point, x4 --> context id, as for CPU_ON.
+		 * x0 --> PSCI error code of the first cpu not turned on.
+		 * x1 --> bitmap of the Aff0 values of the cpus turned on.
+		 */
+		rc = psci_cpu_on_batch(x1, x2, (uintptr_t)x3, x4,
+				       &started);
+		SMC_RET2(handle, (u_register_t)rc, started);
+
+	default:
+		break;
+	}
+
+	WARN("Unimplemented batch CPU_ON Call: 0x%x \n", smc_fid);
+	SMC_RET1(handle, SMC_UNK);
+}
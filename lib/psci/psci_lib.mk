@@ -24,7 +24,9 @@ ifeq (${ARCH}, aarch64)
 PSCI_LIB_SOURCES	+=	lib/el3_runtime/aarch64/context.S
 endif
 
-ifeq (${USE_COHERENT_MEM}, 1)
+ifeq (${BAKERY_LOCK_TICKET}, 1)
+PSCI_LIB_SOURCES		+=	lib/locks/exclusive/${ARCH}/ticket_lock.S
+else ifeq (${USE_COHERENT_MEM}, 1)
 PSCI_LIB_SOURCES		+=	lib/locks/bakery/bakery_lock_coherent.c
 else
 PSCI_LIB_SOURCES		+=	lib/locks/bakery/bakery_lock_normal.c
@@ -11,6 +11,7 @@
 #include <debug.h>
 #include <platform.h>
 #include <pmf.h>
+#include <psci_cpu_on_batch.h>
 #include <runtime_instr.h>
 #include <smccc.h>
 #include <string.h>
@@ -44,6 +45,62 @@ int psci_cpu_on(u_register_t target_cpu,
 	return psci_cpu_on_start(target_cpu, &ep);
 }
 
+#if PSCI_CPU_ON_BATCH
+/*******************************************************************************
+ * Batch CPU_ON: turns on the cpus whose mpidr is `mpidr_base` with its Aff0
+ * field replaced by the position of each bit set in `aff0_mask`, validating
+ * the entry point once for all of them. Bit `n` of `started` is set if the
+ * cpu with Aff0 `n` is being turned on.
+ ******************************************************************************/
+int psci_cpu_on_batch(u_register_t mpidr_base,
+		      u_register_t aff0_mask,
+		      uintptr_t entrypoint,
+		      u_register_t context_id,
+		      unsigned int *started)
+{
+	int rc;
+	entry_point_info_t ep;
+	u_register_t target_cpus[PSCI_CPU_ON_BATCH_MAX_CPUS];
+	unsigned int aff0[PSCI_CPU_ON_BATCH_MAX_CPUS];
+	unsigned int count = 0U, i, on_mask;
+
+	*started = 0U;
+
+	if ((aff0_mask == 0U) ||
+	    ((aff0_mask >> PSCI_CPU_ON_BATCH_MAX_CPUS) != 0U) ||
+	    ((mpidr_base & (MPIDR_AFFLVL_MASK << MPIDR_AFF0_SHIFT)) != 0U))
+		return PSCI_E_INVALID_PARAMS;
+
+	/* Determine if the cpus exist or not */
+	for (i = 0U; i < PSCI_CPU_ON_BATCH_MAX_CPUS; i++) {
+		if ((aff0_mask & (1U << i)) == 0U)
+			continue;
+
+		target_cpus[count] = mpidr_base |
+				     ((u_register_t)i << MPIDR_AFF0_SHIFT);
+		if (psci_validate_mpidr(target_cpus[count]) != PSCI_E_SUCCESS)
+			return PSCI_E_INVALID_PARAMS;
+
+		aff0[count] = i;
+		count++;
+	}
+
+	/* Validate the entry point and get the entry_point_info */
+	rc = psci_validate_entry_point(&ep, entrypoint, context_id);
+	if (rc != PSCI_E_SUCCESS)
+		return rc;
+
+	rc = psci_cpu_on_batch_start(target_cpus, count, &ep, &on_mask);
+
+	for (i = 0U; i < count; i++) {
+		if ((on_mask & (1U << i)) != 0U)
+			*started |= (1U << aff0[i]);
+	}
+
+	return rc;
+}
+#endif /* PSCI_CPU_ON_BATCH */
+
 unsigned int psci_version(void)
 {
 	return PSCI_MAJOR_VER | PSCI_MINOR_VER;
@@ -58,6 +115,9 @@ int psci_cpu_suspend(unsigned int power_state,
 	entry_point_info_t ep;
 	psci_power_state_t state_info = { {PSCI_LOCAL_STATE_RUN} };
 	plat_local_state_t cpu_pd_state;
+#if PSCI_STAT_HIST
+	u_register_t wake_ts;
+#endif
 
 	/* Validate the power_state parameter */
 	rc = psci_validate_power_state(power_state, &state_info);
@@ -105,6 +165,10 @@ int psci_cpu_suspend(unsigned int power_state,
 
 		psci_plat_pm_ops->cpu_standby(cpu_pd_state);
 
+#if PSCI_STAT_HIST
+		wake_ts = read_cntpct_el0();
+#endif
+
 		/* Upon exit from standby, set the state back to RUN. */
 		psci_set_cpu_local_state(PSCI_LOCAL_STATE_RUN);
 
@@ -121,6 +185,10 @@ int psci_cpu_suspend(unsigned int power_state,
 		psci_stats_update_pwr_up(PSCI_CPU_PWR_LVL, &state_info);
 #endif
 
+#if PSCI_STAT_HIST
+		psci_stats_update_wakeup(wake_ts);
+#endif
+
 		return PSCI_E_SUCCESS;
 	}
 
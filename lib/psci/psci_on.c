@@ -11,6 +11,7 @@
 #include <context_mgmt.h>
 #include <debug.h>
 #include <platform.h>
+#include <psci_cpu_on_batch.h>
 #include <pubsub_events.h>
 #include <stddef.h>
 #include "psci_private.h"
@@ -44,6 +45,41 @@ static int cpu_on_validate_state(aff_info_state_t aff_state)
 	return PSCI_E_SUCCESS;
 }
 
+/*******************************************************************************
+ * This function sets the affinity info state of a cpu which is about to be
+ * turned on to ON_PENDING. It is called with the cpu lock of the target held.
+ ******************************************************************************/
+static void cpu_on_set_pending(int target_idx)
+{
+	aff_info_state_t target_aff_state;
+
+	/*
+	 * Set the Affinity info state of the target cpu to ON_PENDING.
+	 * Flush aff_info_state as it will be accessed with caches
+	 * turned OFF.
+	 */
+	psci_set_aff_info_state_by_idx(target_idx, AFF_STATE_ON_PENDING);
+	flush_cpu_data_by_index((unsigned int)target_idx,
+				psci_svc_cpu_data.aff_info_state);
+
+	/*
+	 * The cache line invalidation by the target CPU after setting the
+	 * state to OFF (see psci_do_cpu_off()), could cause the update to
+	 * aff_info_state to be invalidated. Retry the update if the target
+	 * CPU aff_info_state is not ON_PENDING.
+	 */
+	target_aff_state = psci_get_aff_info_state_by_idx(target_idx);
+	if (target_aff_state != AFF_STATE_ON_PENDING) {
+		assert(target_aff_state == AFF_STATE_OFF);
+		psci_set_aff_info_state_by_idx(target_idx, AFF_STATE_ON_PENDING);
+		flush_cpu_data_by_index((unsigned int)target_idx,
+					psci_svc_cpu_data.aff_info_state);
+
+		assert(psci_get_aff_info_state_by_idx(target_idx) ==
+		       AFF_STATE_ON_PENDING);
+	}
+}
+
 /*******************************************************************************
  * Generic handler which is called to physically power on a cpu identified by
  * its mpidr. It performs the generic, architectural, platform setup and state
@@ -58,7 +94,6 @@ int psci_cpu_on_start(u_register_t target_cpu,
 		      const entry_point_info_t *ep)
 {
 	int rc;
-	aff_info_state_t target_aff_state;
 	int target_idx = plat_core_pos_by_mpidr(target_cpu);
 
 	/* Calling function must supply valid input arguments */
@@ -105,31 +140,7 @@ int psci_cpu_on_start(u_register_t target_cpu,
 	if ((psci_spd_pm != NULL) && (psci_spd_pm->svc_on != NULL))
 		psci_spd_pm->svc_on(target_cpu);
 
-	/*
-	 * Set the Affinity info state of the target cpu to ON_PENDING.
-	 * Flush aff_info_state as it will be accessed with caches
-	 * turned OFF.
-	 */
-	psci_set_aff_info_state_by_idx(target_idx, AFF_STATE_ON_PENDING);
-	flush_cpu_data_by_index((unsigned int)target_idx,
-				psci_svc_cpu_data.aff_info_state);
-
-	/*
-	 * The cache line invalidation by the target CPU after setting the
-	 * state to OFF (see psci_do_cpu_off()), could cause the update to
-	 * aff_info_state to be invalidated. Retry the update if the target
-	 * CPU aff_info_state is not ON_PENDING.
-	 */
-	target_aff_state = psci_get_aff_info_state_by_idx(target_idx);
-	if (target_aff_state != AFF_STATE_ON_PENDING) {
-		assert(target_aff_state == AFF_STATE_OFF);
-		psci_set_aff_info_state_by_idx(target_idx, AFF_STATE_ON_PENDING);
-		flush_cpu_data_by_index((unsigned int)target_idx,
-					psci_svc_cpu_data.aff_info_state);
-
-		assert(psci_get_aff_info_state_by_idx(target_idx) ==
-		       AFF_STATE_ON_PENDING);
-	}
+	cpu_on_set_pending(target_idx);
 
 	/*
 	 * Perform generic, architecture and platform specific handling.
@@ -157,6 +168,149 @@ exit:
 	return rc;
 }
 
+#if PSCI_CPU_ON_BATCH
+/*******************************************************************************
+ * Generic handler which is called to physically power on the `count` cpus
+ * identified by their mpidrs in `target_cpus`, all with the same entry point.
+ * The mpidrs must be valid. The cpu locks of the targets are acquired in
+ * their order, which must be the same for all the callers; the batches
+ * built by psci_cpu_on_batch() are sorted by increasing Aff0.
+ *
+ * Targets which are not off are skipped, and their cpu lock released at once
+ * as they may wait for it with power domain locks held, and the error of the
+ * first one is returned. The other targets are powered on by a single call to
+ * the `pwr_domain_on_batch` platform hook, if implemented. Bit `i` of
+ * `started` is set if `target_cpus[i]` is being powered on.
+ *
+ * When the power domains above a target are already running, their state is
+ * coordinated here, once for the batch, so that the target does not take
+ * their locks on the warm boot path (see psci_cpu_on_precoordinate()).
+ ******************************************************************************/
+int psci_cpu_on_batch_start(const u_register_t *target_cpus,
+			    unsigned int count,
+			    const entry_point_info_t *ep,
+			    unsigned int *started)
+{
+	int rc, ret = PSCI_E_SUCCESS;
+	int target_idx[PSCI_CPU_ON_BATCH_MAX_CPUS];
+	u_register_t on_cpus[PSCI_CPU_ON_BATCH_MAX_CPUS];
+	unsigned int on_count = 0U, i, j;
+	unsigned int pending_mask = 0U, on_mask, precoord_mask = 0U;
+	unsigned int batch_mask = 0U;
+
+	assert((count > 0U) && (count <= PSCI_CPU_ON_BATCH_MAX_CPUS));
+	assert(ep != NULL);
+	assert(started != NULL);
+	assert((psci_plat_pm_ops->pwr_domain_on != NULL) &&
+	       (psci_plat_pm_ops->pwr_domain_on_finish != NULL));
+
+	for (i = 0U; i < count; i++) {
+		target_idx[i] = plat_core_pos_by_mpidr(target_cpus[i]);
+		assert(target_idx[i] >= 0);
+
+		psci_spin_lock_cpu(target_idx[i]);
+
+		/* See psci_cpu_on_start() for the cache maintenance */
+		flush_cpu_data_by_index((unsigned int)target_idx[i],
+					psci_svc_cpu_data.aff_info_state);
+		rc = cpu_on_validate_state(
+				psci_get_aff_info_state_by_idx(target_idx[i]));
+		if (rc != PSCI_E_SUCCESS) {
+			psci_spin_unlock_cpu(target_idx[i]);
+			if (ret == PSCI_E_SUCCESS)
+				ret = rc;
+			continue;
+		}
+
+		if ((psci_spd_pm != NULL) && (psci_spd_pm->svc_on != NULL))
+			psci_spd_pm->svc_on(target_cpus[i]);
+
+		cpu_on_set_pending(target_idx[i]);
+
+		if (psci_cpu_on_precoordinate(target_idx[i]))
+			precoord_mask |= (1U << i);
+
+		on_cpus[on_count] = target_cpus[i];
+		on_count++;
+		pending_mask |= (1U << i);
+	}
+
+	on_mask = pending_mask;
+	if (on_count == 0U)
+		goto exit;
+
+	/*
+	 * Plat. management: Power on all the targets at once if the platform
+	 * supports it, one by one otherwise.
+	 */
+	if (psci_plat_pm_ops->pwr_domain_on_batch != NULL) {
+		rc = psci_plat_pm_ops->pwr_domain_on_batch(on_cpus, on_count,
+							   &batch_mask);
+		assert((rc == PSCI_E_SUCCESS) || (rc == PSCI_E_INTERN_FAIL));
+		if (rc != PSCI_E_SUCCESS) {
+			/* Keep the targets the platform powered on anyway */
+			for (i = 0U, j = 0U; i < count; i++) {
+				if ((pending_mask & (1U << i)) == 0U)
+					continue;
+				if ((batch_mask & (1U << j)) == 0U)
+					on_mask &= ~(1U << i);
+				j++;
+			}
+		}
+	} else {
+		for (i = 0U; i < count; i++) {
+			if ((on_mask & (1U << i)) == 0U)
+				continue;
+
+			rc = psci_plat_pm_ops->pwr_domain_on(target_cpus[i]);
+			assert((rc == PSCI_E_SUCCESS) ||
+			       (rc == PSCI_E_INTERN_FAIL));
+			if (rc != PSCI_E_SUCCESS)
+				on_mask &= ~(1U << i);
+		}
+	}
+
+	/* Store the re-entry information for the non-secure world. */
+	for (i = 0U; i < count; i++) {
+		if ((on_mask & (1U << i)) != 0U)
+			cm_init_context_by_index((unsigned int)target_idx[i], ep);
+	}
+
+	/*
+	 * Release the cpu locks of the targets being powered on before the
+	 * reverts below take the power domain locks: a woken target which was
+	 * not precoordinated takes them on the warm boot path and then waits
+	 * for its cpu lock in psci_cpu_on_finish().
+	 */
+	for (i = count; i > 0U; i--) {
+		if ((on_mask & (1U << (i - 1U))) != 0U)
+			psci_spin_unlock_cpu(target_idx[i - 1U]);
+	}
+
+	/*
+	 * Restore the state of the targets which could not be powered on. They
+	 * do not wake up, so their cpu locks can be held until it is done.
+	 */
+	for (i = 0U; i < count; i++) {
+		if (((pending_mask & ~on_mask) & (1U << i)) == 0U)
+			continue;
+
+		if ((precoord_mask & (1U << i)) != 0U)
+			psci_cpu_on_precoordinate_revert(target_idx[i]);
+		psci_set_aff_info_state_by_idx(target_idx[i], AFF_STATE_OFF);
+		flush_cpu_data_by_index((unsigned int)target_idx[i],
+					psci_svc_cpu_data.aff_info_state);
+		psci_spin_unlock_cpu(target_idx[i]);
+		if (ret == PSCI_E_SUCCESS)
+			ret = PSCI_E_INTERN_FAIL;
+	}
+
+exit:
+	*started = on_mask;
+	return ret;
+}
+#endif /* PSCI_CPU_ON_BATCH */
+
 /*******************************************************************************
  * The following function finish an earlier power on request. They
  * are called by the common finisher routine in psci_common.c. The `state_info`
@@ -198,6 +352,16 @@ void psci_cpu_on_finish(int cpu_idx, const psci_power_state_t *state_info)
 	/* Ensure we have been explicitly woken up by another cpu */
 	assert(psci_get_aff_info_state() == AFF_STATE_ON_PENDING);
 
+#if PSCI_CPU_ON_BATCH
+	/*
+	 * Reset the target power level set by psci_cpu_on_precoordinate(), and
+	 * flush it as it is read with the data cache disabled on the next warm
+	 * boot.
+	 */
+	psci_set_suspend_pwrlvl(PSCI_INVALID_PWR_LVL);
+	psci_flush_cpu_data(psci_svc_cpu_data.target_pwrlvl);
+#endif
+
 	/*
 	 * Call the cpu on finish handler registered by the Secure Payload
 	 * Dispatcher to let it do any bookeeping. If the handler encounters an
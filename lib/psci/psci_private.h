@@ -44,54 +44,12 @@
 /*
  * Helper functions to get/set the fields of PSCI per-cpu data.
  */
-static inline void psci_set_aff_info_state(aff_info_state_t aff_state)
-{
-	set_cpu_data(psci_svc_cpu_data.aff_info_state, aff_state);
-}
-
-static inline aff_info_state_t psci_get_aff_info_state(void)
-{
-	return get_cpu_data(psci_svc_cpu_data.aff_info_state);
-}
-
-static inline aff_info_state_t psci_get_aff_info_state_by_idx(int idx)
-{
-	return get_cpu_data_by_index((unsigned int)idx,
-				     psci_svc_cpu_data.aff_info_state);
-}
-
-static inline void psci_set_aff_info_state_by_idx(int idx,
-						  aff_info_state_t aff_state)
-{
-	set_cpu_data_by_index((unsigned int)idx,
-			      psci_svc_cpu_data.aff_info_state, aff_state);
-}
-
-static inline unsigned int psci_get_suspend_pwrlvl(void)
-{
-	return get_cpu_data(psci_svc_cpu_data.target_pwrlvl);
-}
-
-static inline void psci_set_suspend_pwrlvl(unsigned int target_lvl)
-{
-	set_cpu_data(psci_svc_cpu_data.target_pwrlvl, target_lvl);
-}
-
-static inline void psci_set_cpu_local_state(plat_local_state_t state)
-{
-	set_cpu_data(psci_svc_cpu_data.local_state, state);
-}
-
-static inline plat_local_state_t psci_get_cpu_local_state(void)
-{
-	return get_cpu_data(psci_svc_cpu_data.local_state);
-}
-
-static inline plat_local_state_t psci_get_cpu_local_state_by_idx(int idx)
-{
-	return get_cpu_data_by_index((unsigned int)idx,
-				     psci_svc_cpu_data.local_state);
-}
+DEFINE_CPU_DATA_ACCESSORS(psci, aff_info_state, aff_info_state_t,
+			  psci_svc_cpu_data.aff_info_state)
+DEFINE_CPU_DATA_ACCESSORS(psci, suspend_pwrlvl, unsigned int,
+			  psci_svc_cpu_data.target_pwrlvl)
+DEFINE_CPU_DATA_ACCESSORS(psci, cpu_local_state, plat_local_state_t,
+			  psci_svc_cpu_data.local_state)
 
 /* Helper function to identify a CPU standby request in PSCI Suspend call */
 static inline bool is_cpu_standby_req(unsigned int is_power_down_state,
@@ -106,6 +64,11 @@ static inline bool is_cpu_standby_req(unsigned int is_power_down_state,
  * described by the platform. The tree consists of nodes that describe CPU power
  * domains i.e. leaf nodes and all other power domains which are parents of a
  * CPU power domain i.e. non-leaf nodes.
+ *
+ * Each node is in a cache line of its own, as the nodes of different power
+ * domains are written concurrently by the CPUs within them, e.g. the lock of a
+ * CPU node by CPU_ON and the local state of a cluster node during its state
+ * coordination.
  ******************************************************************************/
 typedef struct non_cpu_pwr_domain_node {
 	/*
@@ -133,7 +96,7 @@ typedef struct non_cpu_pwr_domain_node {
 
 	/* For indexing the psci_lock array*/
 	unsigned char lock_index;
-} non_cpu_pd_node_t;
+} __aligned(CACHE_WRITEBACK_GRANULE) non_cpu_pd_node_t;
 
 typedef struct cpu_pwr_domain_node {
 	u_register_t mpidr;
@@ -151,7 +114,7 @@ typedef struct cpu_pwr_domain_node {
 	 * when multiple CPUs try to turn ON the same target CPU.
 	 */
 	spinlock_t cpu_lock;
-} cpu_pd_node_t;
+} __aligned(CACHE_WRITEBACK_GRANULE) cpu_pd_node_t;
 
 /*******************************************************************************
  * The following are helpers and declarations of locks.
@@ -159,9 +122,14 @@ typedef struct cpu_pwr_domain_node {
 #if HW_ASSISTED_COHERENCY
 /*
  * On systems where participant CPUs are cache-coherent, we can use spinlocks
- * instead of bakery locks.
+ * instead of bakery locks. Each lock is in a cache line of its own so that
+ * the coordination of different power domains does not contend on it.
  */
-#define DEFINE_PSCI_LOCK(_name)		spinlock_t _name
+typedef struct psci_spinlock {
+	spinlock_t lock;
+} __aligned(CACHE_WRITEBACK_GRANULE) psci_spinlock_t;
+
+#define DEFINE_PSCI_LOCK(_name)		psci_spinlock_t _name
 #define DECLARE_PSCI_LOCK(_name)	extern DEFINE_PSCI_LOCK(_name)
 
 /* One lock is required per non-CPU power domain node */
@@ -188,12 +156,12 @@ static inline void psci_dsbish(void)
 
 static inline void psci_lock_get(non_cpu_pd_node_t *non_cpu_pd_node)
 {
-	spin_lock(&psci_locks[non_cpu_pd_node->lock_index]);
+	spin_lock(&psci_locks[non_cpu_pd_node->lock_index].lock);
 }
 
 static inline void psci_lock_release(non_cpu_pd_node_t *non_cpu_pd_node)
 {
-	spin_unlock(&psci_locks[non_cpu_pd_node->lock_index]);
+	spin_unlock(&psci_locks[non_cpu_pd_node->lock_index].lock);
 }
 
 #else /* if HW_ASSISTED_COHERENCY == 0 */
@@ -280,6 +248,10 @@ int psci_validate_suspend_req(const psci_power_state_t *state_info,
 unsigned int psci_find_max_off_lvl(const psci_power_state_t *state_info);
 unsigned int psci_find_target_suspend_lvl(const psci_power_state_t *state_info);
 void psci_set_pwr_domains_to_run(unsigned int end_pwrlvl);
+#if PSCI_CPU_ON_BATCH
+bool psci_cpu_on_precoordinate(int cpu_idx);
+void psci_cpu_on_precoordinate_revert(int cpu_idx);
+#endif
 void psci_print_power_domain_map(void);
 unsigned int psci_is_last_on_cpu(void);
 int psci_spd_migrate_info(u_register_t *mpidr);
@@ -297,6 +269,12 @@ int psci_cpu_on_start(u_register_t target_cpu,
 		      const entry_point_info_t *ep);
 
 void psci_cpu_on_finish(int cpu_idx, const psci_power_state_t *state_info);
+#if PSCI_CPU_ON_BATCH
+int psci_cpu_on_batch_start(const u_register_t *target_cpus,
+			    unsigned int count,
+			    const entry_point_info_t *ep,
+			    unsigned int *started);
+#endif
 
 /* Private exported functions from psci_off.c */
 int psci_do_cpu_off(unsigned int end_pwrlvl);
@@ -327,6 +305,10 @@ u_register_t psci_stat_residency(u_register_t target_cpu,
 			unsigned int power_state);
 u_register_t psci_stat_count(u_register_t target_cpu,
 			unsigned int power_state);
+#if PSCI_STAT_HIST
+u_register_t psci_stats_warmboot_wake_ts(void);
+void psci_stats_update_wakeup(u_register_t wake_ts);
+#endif
 
 /* Private exported functions from psci_mem_protect.c */
 u_register_t psci_mem_protect(unsigned int enable);
@@ -8,6 +8,8 @@
 #include <debug.h>
 #include <platform.h>
 #include <platform_def.h>
+#include <psci_stat_hist.h>
+#include <string.h>
 #include "psci_private.h"
 
 #ifndef PLAT_MAX_PWR_LVL_STATES
@@ -36,6 +38,49 @@ static psci_stat_t psci_cpu_stat[PLATFORM_CORE_COUNT]
 static psci_stat_t psci_non_cpu_stat[PSCI_NUM_NON_CPU_PWR_DOMAINS]
 				[PLAT_MAX_PWR_LVL_STATES];
 
+#if PSCI_STAT_HIST
+#define NSEC_PER_SEC	ULL(1000000000)
+
+/*
+ * Following are used to keep the histograms of the CPU power domain states.
+ * Each CPU only updates its own entry, which is cache line aligned so that
+ * the updates do not bounce cache lines between CPUs.
+ */
+typedef struct psci_cpu_stat_hist {
+	psci_stat_hist_t state[PLAT_MAX_PWR_LVL_STATES];
+	/* Index of the state this CPU last woke up from */
+	unsigned int last_idx;
+} __aligned(CACHE_WRITEBACK_GRANULE) psci_cpu_stat_hist_t;
+
+static psci_cpu_stat_hist_t psci_cpu_stat_hist[PLATFORM_CORE_COUNT];
+
+/*
+ * Time at which each CPU entered bl31_warm_entrypoint. It is written with the
+ * data cache disabled, so each CPU has a cache line of its own.
+ */
+uint64_t psci_stat_wake_ts[PLATFORM_CORE_COUNT]
+			[CACHE_WRITEBACK_GRANULE / sizeof(uint64_t)]
+			__aligned(CACHE_WRITEBACK_GRANULE);
+
+/*
+ * This function returns the histogram bucket of `val`: 0 for 0, otherwise the
+ * number of significant bits of `val`, saturated at the last bucket.
+ */
+static unsigned int psci_stat_hist_bucket(uint64_t val)
+{
+	unsigned int bucket;
+
+	if (val == 0U)
+		return 0U;
+
+	bucket = 64U - (unsigned int)__builtin_clzll(val);
+	if (bucket >= PSCI_STAT_HIST_BUCKETS)
+		bucket = PSCI_STAT_HIST_BUCKETS - 1U;
+
+	return bucket;
+}
+#endif /* PSCI_STAT_HIST */
+
 /*
  * This functions returns the index into the `psci_stat_t` array given the
  * local power state and power domain level. If the platform implements the
@@ -127,6 +172,18 @@ void psci_stats_update_pwr_up(unsigned int end_pwrlvl,
 	psci_cpu_stat[cpu_idx][stat_idx].residency += residency;
 	psci_cpu_stat[cpu_idx][stat_idx].count++;
 
+#if PSCI_STAT_HIST
+	{
+		psci_stat_hist_t *hist =
+			&psci_cpu_stat_hist[cpu_idx].state[stat_idx];
+
+		hist->count++;
+		hist->residency_total += residency;
+		hist->residency[psci_stat_hist_bucket(residency)]++;
+		psci_cpu_stat_hist[cpu_idx].last_idx = (unsigned int)stat_idx;
+	}
+#endif
+
 	/*
 	 * Check what power domains above CPU were off
 	 * prior to this CPU powering on.
@@ -245,3 +302,77 @@ u_register_t psci_stat_count(u_register_t target_cpu,
 	else
 		return 0;
 }
+
+#if PSCI_STAT_HIST
+/*******************************************************************************
+ * This function returns the time at which this CPU entered the warm boot
+ * entrypoint. The timestamp was written with the data cache disabled, so the
+ * cache line is invalidated before reading it.
+ ******************************************************************************/
+u_register_t psci_stats_warmboot_wake_ts(void)
+{
+	uint64_t *ts = psci_stat_wake_ts[plat_my_core_pos()];
+
+	inv_dcache_range((uintptr_t)ts, sizeof(*ts));
+
+	return *ts;
+}
+
+/*******************************************************************************
+ * This function records the wakeup latency of this CPU, from `wake_ts`, the
+ * time at which it left the low power state, until now, when it is about to
+ * return to the caller. It is accounted to the state passed to the last call
+ * to psci_stats_update_pwr_up() on this CPU.
+ ******************************************************************************/
+void psci_stats_update_wakeup(u_register_t wake_ts)
+{
+	psci_cpu_stat_hist_t *cpu_hist =
+		&psci_cpu_stat_hist[plat_my_core_pos()];
+	psci_stat_hist_t *hist = &cpu_hist->state[cpu_hist->last_idx];
+	uint64_t latency;
+
+	latency = ((read_cntpct_el0() - wake_ts) * NSEC_PER_SEC) /
+		read_cntfrq_el0();
+
+	hist->wakeups++;
+	hist->wakeup_total += latency;
+	hist->wakeup[psci_stat_hist_bucket(latency)]++;
+}
+
+/*******************************************************************************
+ * This function copies the histograms of all the CPUs into `buf`, after a
+ * psci_stat_hist_hdr_t header. The histograms of the other CPUs may be updated
+ * during the copy, so a record can be inconsistent with the following ones.
+ * It returns the number of bytes written, or 0 if `size` is too small.
+ ******************************************************************************/
+size_t psci_stat_hist_export(void *buf, size_t size)
+{
+	psci_stat_hist_hdr_t *hdr = buf;
+	psci_stat_hist_t *rec = (psci_stat_hist_t *)(hdr + 1);
+	size_t len = PSCI_STAT_HIST_EXPORT_SIZE(PLATFORM_CORE_COUNT,
+			PLAT_MAX_PWR_LVL_STATES);
+	unsigned int i;
+
+	if (size < len)
+		return 0U;
+
+	hdr->version = PSCI_STAT_HIST_VERSION;
+	hdr->cpu_count = PLATFORM_CORE_COUNT;
+	hdr->state_count = PLAT_MAX_PWR_LVL_STATES;
+	hdr->bucket_count = PSCI_STAT_HIST_BUCKETS;
+
+	for (i = 0U; i < PLATFORM_CORE_COUNT; i++) {
+		(void)memcpy(rec, psci_cpu_stat_hist[i].state,
+			     sizeof(psci_cpu_stat_hist[i].state));
+		rec += PLAT_MAX_PWR_LVL_STATES;
+	}
+
+	return len;
+}
+
+/* This function clears the histograms of all the CPUs. */
+void psci_stat_hist_reset(void)
+{
+	(void)memset(psci_cpu_stat_hist, 0, sizeof(psci_cpu_stat_hist));
+}
+#endif /* PSCI_STAT_HIST */
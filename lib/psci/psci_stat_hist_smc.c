@@ -0,0 +1,64 @@
+/*
+ * Copyright (c) 2018, ARM Limited and Contributors. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <debug.h>
+#include <platform_def.h>
+#include <psci_stat_hist.h>
+#include <smccc_helpers.h>
+
+/*
+ * The platform provides the non-secure buffer the histograms are exported to.
+ */
+#if !defined(PLAT_PSCI_STAT_HIST_BUF_BASE) || \
+	!defined(PLAT_PSCI_STAT_HIST_BUF_SIZE)
+#error "PSCI_STAT_HIST requires PLAT_PSCI_STAT_HIST_BUF_BASE/SIZE"
+#endif
+
+/*
+ * This function is responsible for handling all PSCI statistics histograms
+ * SMC calls.
+ */
+uintptr_t psci_stat_hist_smc_handler(unsigned int smc_fid,
+			u_register_t x1,
+			u_register_t x2,
+			u_register_t x3,
+			u_register_t x4,
+			void *cookie,
+			void *handle,
+			u_register_t flags)
+{
+	size_t len;
+
+	switch (smc_fid) {
+	case PSCI_STAT_HIST_SMC_EXPORT:
+		/*
+		 * Copy the histograms of all the CPUs to the export buffer.
+		 * x0 --> error code.
+		 * x1 --> address of the buffer.
+		 * x2 --> number of bytes written, see psci_stat_hist_hdr_t.
+		 */
+		len = psci_stat_hist_export(
+				(void *)PLAT_PSCI_STAT_HIST_BUF_BASE,
+				PLAT_PSCI_STAT_HIST_BUF_SIZE);
+		if (len == 0U) {
+			WARN("PSCI statistics histograms buffer too small\n");
+			break;
+		}
+
+		SMC_RET3(handle, SMC_OK, PLAT_PSCI_STAT_HIST_BUF_BASE, len);
+
+	case PSCI_STAT_HIST_SMC_RESET:
+		psci_stat_hist_reset();
+		SMC_RET1(handle, SMC_OK);
+
+	default:
+		WARN("Unimplemented PSCI statistics histograms Call: 0x%x \n",
+		     smc_fid);
+		break;
+	}
+
+	SMC_RET1(handle, SMC_UNK);
+}
@@ -154,6 +154,9 @@ void psci_cpu_suspend_start(const entry_point_info_t *ep,
 {
 	int skip_wfi = 0;
 	int idx = (int) plat_my_core_pos();
+#if PSCI_STAT_HIST
+	u_register_t wake_ts;
+#endif
 
 	/*
 	 * This function must only be called on platforms where the
@@ -251,6 +254,10 @@ exit:
 	 */
 	wfi();
 
+#if PSCI_STAT_HIST
+	wake_ts = read_cntpct_el0();
+#endif
+
 #if ENABLE_RUNTIME_INSTRUMENTATION
 	PMF_CAPTURE_TIMESTAMP(rt_instr_svc,
 	    RT_INSTR_EXIT_HW_LOW_PWR,
@@ -262,6 +269,10 @@ exit:
 	 * context retaining suspend finisher.
 	 */
 	psci_suspend_to_standby_finisher(idx, end_pwrlvl);
+
+#if PSCI_STAT_HIST
+	psci_stats_update_wakeup(wake_ts);
+#endif
 }
 
 /*******************************************************************************
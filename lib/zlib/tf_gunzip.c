@@ -22,6 +22,10 @@ static uintptr_t zalloc_start;
 static uintptr_t zalloc_end;
 static uintptr_t zalloc_current;
 
+/* State of the decompression fed by gunzip_stream_feed() */
+static z_stream gunzip_strm;
+static int gunzip_strm_done;
+
 static void * ZLIB_INTERNAL zcalloc(void *opaque, unsigned int items,
 				    unsigned int size)
 {
@@ -46,6 +50,13 @@ static void ZLIB_INTERNAL zfree(void *opaque, void *ptr)
 {
 }
 
+static void zalloc_init(uintptr_t work_buf, size_t work_len)
+{
+	zalloc_start = work_buf;
+	zalloc_end = work_buf + work_len;
+	zalloc_current = zalloc_start;
+}
+
 /*
  * gunzip - decompress gzip data
  * @in_buf: source of compressed input. Upon exit, the end of input.
@@ -61,9 +72,7 @@ int gunzip(uintptr_t *in_buf, size_t in_len, uintptr_t *out_buf,
 	z_stream stream;
 	int zret, ret;
 
-	zalloc_start = work_buf;
-	zalloc_end = work_buf + work_len;
-	zalloc_current = zalloc_start;
+	zalloc_init(work_buf, work_len);
 
 	stream.next_in = (typeof(stream.next_in))*in_buf;
 	stream.avail_in = in_len;
@@ -99,3 +108,96 @@ int gunzip(uintptr_t *in_buf, size_t in_len, uintptr_t *out_buf,
 
 	return ret;
 }
+
+/*
+ * gunzip_stream_init - start to decompress gzip data fed chunk by chunk
+ * @out_buf: destination of decompressed output
+ * @out_len: length of out_buf
+ * @work_buf: workspace
+ * @work_len: length of workspace
+ *
+ * The output is written straight to its destination, so the workspace only
+ * holds the inflate state and its 32KiB sliding window, about 40KiB in total.
+ */
+int gunzip_stream_init(uintptr_t out_buf, size_t out_len,
+		       uintptr_t work_buf, size_t work_len)
+{
+	int zret;
+
+	zalloc_init(work_buf, work_len);
+
+	memset(&gunzip_strm, 0, sizeof(gunzip_strm));
+	gunzip_strm.next_out = (typeof(gunzip_strm.next_out))out_buf;
+	gunzip_strm.avail_out = out_len;
+	gunzip_strm.zalloc = zcalloc;
+	gunzip_strm.zfree = zfree;
+	gunzip_strm.opaque = (voidpf)0;
+	gunzip_strm_done = 0;
+
+	zret = inflateInit(&gunzip_strm);
+	if (zret != Z_OK) {
+		ERROR("zlib: inflate init failed (ret = %d)\n", zret);
+		return (zret == Z_MEM_ERROR) ? -ENOMEM : -EIO;
+	}
+
+	return 0;
+}
+
+/*
+ * gunzip_stream_feed - decompress the next chunk of gzip data
+ * @in_buf: chunk of compressed input, which can be reused on return
+ * @in_len: length of in_buf
+ *
+ * Data fed after the end of the gzip stream is ignored.
+ */
+int gunzip_stream_feed(uintptr_t in_buf, size_t in_len)
+{
+	int zret;
+
+	if (gunzip_strm_done)
+		return 0;
+
+	gunzip_strm.next_in = (typeof(gunzip_strm.next_in))in_buf;
+	gunzip_strm.avail_in = in_len;
+
+	zret = inflate(&gunzip_strm, Z_NO_FLUSH);
+	if (zret == Z_STREAM_END) {
+		gunzip_strm_done = 1;
+		return 0;
+	}
+
+	/* inflate() only leaves input behind if the output is full */
+	if ((zret == Z_OK) && (gunzip_strm.avail_in == 0U))
+		return 0;
+
+	if (gunzip_strm.msg)
+		ERROR("%s\n", gunzip_strm.msg);
+	ERROR("zlib: inflate failed (ret = %d)\n", zret);
+
+	return (zret == Z_MEM_ERROR) ? -ENOMEM : -EIO;
+}
+
+/*
+ * gunzip_stream_finish - end the decompression started by gunzip_stream_init
+ * @out_buf: upon exit, the end of output
+ *
+ * Fails if the input fed so far did not hold a complete gzip stream.
+ */
+int gunzip_stream_finish(uintptr_t *out_buf)
+{
+	int ret = 0;
+
+	if (!gunzip_strm_done) {
+		ERROR("zlib: truncated input\n");
+		ret = -EIO;
+	}
+
+	VERBOSE("zlib: %lu byte input\n", gunzip_strm.total_in);
+	VERBOSE("zlib: %lu byte output\n", gunzip_strm.total_out);
+
+	*out_buf = (uintptr_t)gunzip_strm.next_out;
+
+	inflateEnd(&gunzip_strm);
+
+	return ret;
+}
@@ -23,6 +23,15 @@ ARCH				:= aarch64
 ARM_ARCH_MAJOR			:= 8
 ARM_ARCH_MINOR			:= 0
 
+# Hash the images authenticated by a hash as they are read from storage, in
+# chunks of the given size
+AUTH_STREAM_HASH		:= 0
+AUTH_STREAM_HASH_CHUNK_SIZE	:= 32768
+
+# Implement the bakery lock interface with ticket locks, which need the data
+# cache to be enabled whenever a lock is acquired
+BAKERY_LOCK_TICKET		:= 0
+
 # Base commit to perform code check on
 BASE_COMMIT			:= origin/master
 
@@ -51,6 +60,10 @@ CTX_INCLUDE_AARCH32_REGS	:= 1
 # Include FP registers in cpu context
 CTX_INCLUDE_FPREGS		:= 0
 
+# Only write the EL1 control and MMU registers on a world switch if they change,
+# and let runtime services keep the MMU registers of one world live
+CTX_EL1_LAZY_SWITCH		:= 0
+
 # Debug build
 DEBUG				:= 0
 
@@ -67,6 +80,12 @@ ENABLE_MPAM_FOR_LOWER_ELS	:= 0
 # Flag to Enable Position Independant support (PIE)
 ENABLE_PIE			:= 0
 
+# Flag to enable the tracing of the handling of the interrupts taken to EL3
+ENABLE_INTR_TRACE		:= 0
+
+# Flag to enable contention and hold time statistics of the BL31 locks
+ENABLE_LOCK_STATS		:= 0
+
 # Flag to enable Performance Measurement Framework
 ENABLE_PMF			:= 0
 
@@ -76,6 +95,9 @@ ENABLE_PSCI_STAT		:= 0
 # Flag to enable runtime instrumentation using PMF
 ENABLE_RUNTIME_INSTRUMENTATION	:= 0
 
+# Flag to enable the SMC round-trip latency benchmark service
+ENABLE_SMC_BENCH		:= 0
+
 # Flag to enable stack corruption protection
 ENABLE_STACK_PROTECTOR		:= 0
 
@@ -94,6 +116,9 @@ FIP_ALIGN			:= 0
 # Default FIP file name
 FIP_NAME			:= fip.bin
 
+# Keep the ToC of the FIP in memory and its backend open across images
+FIP_TOC_CACHE			:= 0
+
 # Default FWU_FIP file name
 FWU_FIP_NAME			:= fwu_fip.bin
 
@@ -112,6 +137,9 @@ HANDLE_EA_EL3_FIRST		:= 0
 # operations.
 HW_ASSISTED_COHERENCY		:= 0
 
+# Decompress the compressed images loaded by BL2 while they are read
+IMAGE_DECOMPRESS_STREAM		:= 0
+
 # Set the default algorithm for the generation of Trusted Board Boot keys
 KEY_ALG				:= rsa
 
@@ -129,10 +157,20 @@ PL011_GENERIC_UART		:= 0
 # The platform Makefile is free to override this value.
 PROGRAMMABLE_RESET_ADDRESS	:= 0
 
+# Coordinate PSCI power domain states from per-domain summary counters instead
+# of plat_get_target_pwr_state()
+PSCI_COORD_COUNTERS		:= 0
+
+# Add a SiP call turning on a set of CPUs at once
+PSCI_CPU_ON_BATCH		:= 0
+
 # Flag used to choose the power state format viz Extended State-ID or the
 # Original format.
 PSCI_EXTENDED_STATE_ID		:= 0
 
+# Keep per-CPU histograms of the PSCI residency and wakeup latency
+PSCI_STAT_HIST			:= 0
+
 # Enable RAS support
 RAS_EXTENSION			:= 0
 
@@ -156,6 +194,10 @@ RECLAIM_INIT_CODE		:= 0
 # Default to SMCCC Version 1.X
 SMCCC_MAJOR_VERSION		:= 1
 
+# Whether BL31 serves the SMC function IDs registered with DECLARE_RT_FAST_SMC
+# directly from the exception vectors
+SMC_FAST_PATH			:= 0
+
 # SPD choice
 SPD				:= none
 
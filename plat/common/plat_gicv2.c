@@ -7,6 +7,7 @@
 #include <gic_common.h>
 #include <gicv2.h>
 #include <interrupt_mgmt.h>
+#include <intr_trace.h>
 #include <platform.h>
 #include <stdbool.h>
 
@@ -88,7 +89,11 @@ uint32_t plat_ic_get_pending_interrupt_type(void)
  */
 uint32_t plat_ic_acknowledge_interrupt(void)
 {
-	return gicv2_acknowledge_interrupt();
+	uint32_t intr_raw = gicv2_acknowledge_interrupt();
+
+	intr_trace_ack(intr_raw);
+
+	return intr_raw;
 }
 
 /*
@@ -118,6 +123,7 @@ uint32_t plat_ic_get_interrupt_type(uint32_t id)
 void plat_ic_end_of_interrupt(uint32_t id)
 {
 	gicv2_end_of_interrupt(id);
+	intr_trace_eoi();
 }
 
 /*
@@ -10,6 +10,7 @@
 #include <gic_common.h>
 #include <gicv3.h>
 #include <interrupt_mgmt.h>
+#include <intr_trace.h>
 #include <platform.h>
 #include <stdbool.h>
 
@@ -104,8 +105,13 @@ uint32_t plat_ic_get_pending_interrupt_type(void)
  */
 uint32_t plat_ic_acknowledge_interrupt(void)
 {
+	uint32_t intr_raw;
+
 	assert(IS_IN_EL3());
-	return gicv3_acknowledge_interrupt();
+	intr_raw = gicv3_acknowledge_interrupt();
+	intr_trace_ack(intr_raw);
+
+	return intr_raw;
 }
 
 /*
@@ -127,6 +133,7 @@ void plat_ic_end_of_interrupt(uint32_t id)
 {
 	assert(IS_IN_EL3());
 	gicv3_end_of_interrupt(id);
+	intr_trace_eoi();
 }
 
 /*
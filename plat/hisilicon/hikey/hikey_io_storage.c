@@ -61,6 +61,8 @@ static const io_block_dev_spec_t emmc_dev_spec = {
 	.ops		= {
 		.read	= mmc_read_blocks,
 		.write	= mmc_write_blocks,
+		.read_submit	= mmc_read_blocks_submit,
+		.read_poll	= mmc_read_blocks_poll,
 	},
 	.block_size	= MMC_BLOCK_SIZE,
 };
@@ -16,6 +16,15 @@
 const mmap_region_t plat_arm_mmap[] = {
 	{ DEVICE0_BASE, DEVICE0_BASE, DEVICE0_SIZE, MT_DEVICE | MT_RW | MT_SECURE },
 	{ DEVICE1_BASE, DEVICE1_BASE, DEVICE1_SIZE, MT_DEVICE | MT_RW | MT_SECURE },
+#ifdef HPSC_SHM_BASE
+	/* Shared with TRCH, which is not coherent with us */
+	{ HPSC_SHM_BASE, HPSC_SHM_BASE, HPSC_SHM_SIZE, MT_NON_CACHEABLE | MT_RW | MT_SECURE },
+#endif
+#ifdef PLAT_PSCI_STAT_HIST_BUF_BASE
+	/* Read by the normal world after PSCI_STAT_HIST_SMC_EXPORT */
+	{ PLAT_PSCI_STAT_HIST_BUF_BASE, PLAT_PSCI_STAT_HIST_BUF_BASE,
+	  PLAT_PSCI_STAT_HIST_BUF_SIZE, MT_MEMORY | MT_RW | MT_NS },
+#endif
 	{0}
 };
 
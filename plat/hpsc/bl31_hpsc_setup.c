@@ -13,7 +13,9 @@
 #include <plat_arm.h>
 #include <platform.h>
 #include <generic_delay_timer.h>
+#include <intr_trace.h>
 #include <uart_16550.h>
+#include "hpsc_private.h"
 
 #define BL31_END (unsigned long)(&__BL31_END__)
 
@@ -96,7 +98,13 @@ static void hpsc_testing_setup(void)
 }
 #endif
 
-#if HPSC_WARM_RESTART
+/*
+ * EL3 interrupts serve the warm restart and, with HPSC_MBOX_IRQ, the mailbox
+ * links to TRCH (see pm_ipi.c)
+ */
+#define HPSC_EL3_INTERRUPTS	(HPSC_WARM_RESTART || (TRCH_SERVER && HPSC_MBOX_IRQ))
+
+#if HPSC_EL3_INTERRUPTS
 static interrupt_type_handler_t type_el3_interrupt_table[MAX_INTR_EL3];
 
 /* Register INTR_TYPE_EL3 interrupt handler to specific GIC entrance */
@@ -122,9 +130,14 @@ static uint64_t rdo_el3_interrupt_handler(uint32_t id, uint32_t flags,
 	interrupt_type_handler_t handler;
 
 	intr_id = plat_ic_get_pending_interrupt_id();
+	if (intr_id >= MAX_INTR_EL3)
+		return 0;	/* spurious, e.g. taken by another core */
+
 	handler = type_el3_interrupt_table[intr_id];
-	if (handler != NULL)
+	if (handler != NULL) {
+		intr_trace_dispatch(intr_id);
 		handler(intr_id, flags, handle, cookie);
+	}
 
 	return 0;
 }
@@ -141,7 +154,7 @@ void bl31_platform_setup(void)
 void bl31_plat_runtime_setup(void)
 {
 
-#if HPSC_WARM_RESTART
+#if HPSC_EL3_INTERRUPTS
 	uint64_t flags = 0;
 	uint64_t rc;
 
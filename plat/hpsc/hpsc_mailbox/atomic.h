@@ -0,0 +1,103 @@
+#ifndef ATOMIC_H
+#define ATOMIC_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <utils_def.h>
+
+// Minimal set of atomic operations on 32-bit words, for data shared between
+// cores and interrupt handlers without a lock. ARMv8.1 builds use the LSE
+// instructions, others the exclusive monitor (like spin_lock does).
+
+#ifdef HPSC_MBOX_SIM
+// Host build of the mailbox stack (plat/hpsc/sim)
+
+static inline uint32_t atomic_load_acquire32(volatile uint32_t *p)
+{
+    return __atomic_load_n(p, __ATOMIC_ACQUIRE);
+}
+
+static inline void atomic_store_release32(volatile uint32_t *p, uint32_t v)
+{
+    __atomic_store_n(p, v, __ATOMIC_RELEASE);
+}
+
+static inline bool atomic_cas32(volatile uint32_t *p, uint32_t old, uint32_t new)
+{
+    return __atomic_compare_exchange_n(p, &old, new, false,
+                                       __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE);
+}
+
+static inline uint32_t atomic_add32(volatile uint32_t *p, uint32_t v)
+{
+    return __atomic_add_fetch(p, v, __ATOMIC_ACQ_REL);
+}
+
+#else // !HPSC_MBOX_SIM
+
+static inline uint32_t atomic_load_acquire32(volatile uint32_t *p)
+{
+    uint32_t v;
+    __asm__ volatile("ldar %w0, %1" : "=r" (v) : "Q" (*p) : "memory");
+    return v;
+}
+
+static inline void atomic_store_release32(volatile uint32_t *p, uint32_t v)
+{
+    __asm__ volatile("stlr %w1, %0" : "=Q" (*p) : "r" (v) : "memory");
+}
+
+// Returns true if *p was 'old' and is now 'new'
+static inline bool atomic_cas32(volatile uint32_t *p, uint32_t old, uint32_t new)
+{
+#if ARM_ARCH_AT_LEAST(8, 1)
+    uint32_t cur = old;
+    __asm__ volatile(".arch_extension lse\n"
+                     "casal %w0, %w2, %1"
+                     : "+r" (cur), "+Q" (*p) : "r" (new) : "memory");
+    return cur == old;
+#else
+    uint32_t cur, fail;
+    __asm__ volatile("1: ldaxr %w0, %2\n"
+                     "   cmp %w0, %w3\n"
+                     "   b.ne 2f\n"
+                     "   stlxr %w1, %w4, %2\n"
+                     "   cbnz %w1, 1b\n"
+                     "2:"
+                     : "=&r" (cur), "=&r" (fail), "+Q" (*p)
+                     : "r" (old), "r" (new) : "cc", "memory");
+    return cur == old;
+#endif
+}
+
+// Returns the value after the addition
+static inline uint32_t atomic_add32(volatile uint32_t *p, uint32_t v)
+{
+    uint32_t prev;
+#if ARM_ARCH_AT_LEAST(8, 1)
+    __asm__ volatile(".arch_extension lse\n"
+                     "ldaddal %w2, %w0, %1"
+                     : "=r" (prev), "+Q" (*p) : "r" (v) : "memory");
+#else
+    uint32_t tmp, fail;
+    __asm__ volatile("1: ldaxr %w0, %3\n"
+                     "   add %w1, %w0, %w4\n"
+                     "   stlxr %w2, %w1, %3\n"
+                     "   cbnz %w2, 1b"
+                     : "=&r" (prev), "=&r" (tmp), "=&r" (fail), "+Q" (*p)
+                     : "r" (v) : "memory");
+#endif
+    return prev + v;
+}
+
+#endif // !HPSC_MBOX_SIM
+
+// Raise *p to at least v
+static inline void atomic_max32(volatile uint32_t *p, uint32_t v)
+{
+    uint32_t cur = atomic_load_acquire32(p);
+    while (cur < v && !atomic_cas32(p, cur, v))
+        cur = atomic_load_acquire32(p);
+}
+
+#endif // ATOMIC_H
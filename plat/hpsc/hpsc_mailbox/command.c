@@ -1,17 +1,45 @@
 #include <stdint.h>
-#include <delay_timer.h>
+#include <arch_helpers.h>
 #include <debug.h>
+#include <utils_def.h>
+#include "atomic.h"
 #include "mailbox.h"
+#include "mailbox-link.h"
 #include "server.h"
+#include "sleep.h"
 
 #include "command.h"
 
-#define CMD_QUEUE_LEN 4
+#ifdef HPSC_CMD_QUEUE_LEN
+#define CMD_QUEUE_LEN HPSC_CMD_QUEUE_LEN
+#else
+#define CMD_QUEUE_LEN 16
+#endif
 #define REPLY_SIZE CMD_MSG_LEN
 
-static size_t cmdq_head = 0;
-static size_t cmdq_tail = 0;
-static struct cmd cmdq[CMD_QUEUE_LEN];
+// the handler fills all but the last word, which echoes the tag of the request
+CASSERT(MBOX_LINK_TAG_WORD == REPLY_SIZE - 1, assert_reply_tag_word);
+CASSERT(CMD_QUEUE_LEN >= 2 && !(CMD_QUEUE_LEN & (CMD_QUEUE_LEN - 1)),
+        assert_cmd_queue_len_power_of_two);
+
+// Bounded multi-producer, single-consumer ring. Positions increase forever
+// and map to slot (pos % CMD_QUEUE_LEN); each slot records whose turn it is
+// relative to the lap of the position, LAP(pos):
+//   seq == LAP(pos)     : free, a producer may fill it for 'pos'
+//   seq == LAP(pos) + 1 : filled, the consumer may drain it
+// Draining moves seq on to the next lap. Producers (mailbox ISRs on any core)
+// claim positions by CAS on the head and never wait for each other.
+#define LAP(pos) ((pos) & ~(uint32_t)(CMD_QUEUE_LEN - 1))
+
+struct cmdq_slot {
+    volatile uint32_t seq;
+    struct cmd cmd;
+};
+
+static volatile uint32_t cmdq_head = 0; // next position to claim
+static uint32_t cmdq_tail = 0;          // next position to drain
+static struct cmdq_slot cmdq[CMD_QUEUE_LEN];
+static struct cmd_queue_stats cmdq_stats;
 
 static cmd_handler_t *cmd_handler = NULL;
 
@@ -27,48 +55,92 @@ void cmd_handler_unregister()
 
 int cmd_enqueue(struct cmd *cmd)
 {
+    struct cmdq_slot *slot;
+    uint32_t pos, seq;
     size_t i;
 
-    if (cmdq_head + 1 % CMD_QUEUE_LEN == cmdq_tail) {
-        VERBOSE("cannot enqueue command: queue full\r\n");
-        return 1;
+    pos = atomic_load_acquire32(&cmdq_head);
+    for (;;) {
+        slot = &cmdq[pos % CMD_QUEUE_LEN];
+        seq = atomic_load_acquire32(&slot->seq);
+        if (seq == LAP(pos)) {
+            if (atomic_cas32(&cmdq_head, pos, pos + 1))
+                break;
+            pos = atomic_load_acquire32(&cmdq_head);
+        } else if ((int32_t)(seq - LAP(pos)) < 0) {
+            // slot still holds the command from one lap ago
+            atomic_add32(&cmdq_stats.full, 1);
+            VERBOSE("cannot enqueue command: queue full\r\n");
+            return 1;
+        } else {
+            // another producer claimed this position, retry at the new head
+            pos = atomic_load_acquire32(&cmdq_head);
+        }
     }
-    cmdq_head = (cmdq_head + 1) % CMD_QUEUE_LEN;
 
-    // cmdq[cmdq_head] = *cmd; // can't because GCC inserts a memcpy
-    cmdq[cmdq_head].link = cmd->link;
+    // slot->cmd = *cmd; // can't because GCC inserts a memcpy
+    slot->cmd.link = cmd->link;
     for (i = 0; i < CMD_MSG_LEN; ++i)
-        cmdq[cmdq_head].msg[i] = cmd->msg[i];
+        slot->cmd.msg[i] = cmd->msg[i];
 
-    VERBOSE("enqueue command (tail %lu head %lu): cmd %u arg %u...\r\n",
-           cmdq_tail, cmdq_head, cmdq[cmdq_head].msg[0], cmdq[cmdq_head].msg[1]);
+    // publish the command, then wake a consumer that waits in WFE
+    atomic_store_release32(&slot->seq, LAP(pos) + 1);
+    dsbishst();
+    sev();
 
-    // TODO: SEV (to prevent race between queue check and WFE in main loop)
+    atomic_add32(&cmdq_stats.enqueued, 1);
+    atomic_max32(&cmdq_stats.max_depth, pos + 1 - cmdq_tail);
 
+    VERBOSE("enqueue command (pos %u): cmd %u arg %u...\r\n",
+           pos, cmd->msg[0], cmd->msg[1]);
     return 0;
 }
 
 int cmd_dequeue(struct cmd *cmd)
 {
-    size_t i;
-
-    if (cmdq_head == cmdq_tail)
-        return 1;
-
-    cmdq_tail = (cmdq_tail + 1) % CMD_QUEUE_LEN;
+    return cmd_dequeue_batch(cmd, 1) ? 0 : 1;
+}
 
-    // *cmd = cmdq[cmdq_tail].cmd; // can't because GCC inserts a memcpy
-    cmd->link = cmdq[cmdq_tail].link;
-    for (i = 0; i < CMD_MSG_LEN; ++i)
-        cmd->msg[i] = cmdq[cmdq_tail].msg[i];
-    VERBOSE("dequeue command (tail %lu head %lu): cmd %u arg %u...\r\n",
-           cmdq_tail, cmdq_head, cmdq[cmdq_tail].msg[0], cmdq[cmdq_tail].msg[1]);
-    return 0;
+size_t cmd_dequeue_batch(struct cmd *cmds, size_t max)
+{
+    struct cmdq_slot *slot;
+    size_t n, i;
+
+    for (n = 0; n < max; ++n) {
+        slot = &cmdq[cmdq_tail % CMD_QUEUE_LEN];
+        if (atomic_load_acquire32(&slot->seq) != LAP(cmdq_tail) + 1)
+            break;
+
+        // cmds[n] = slot->cmd; // can't because GCC inserts a memcpy
+        cmds[n].link = slot->cmd.link;
+        for (i = 0; i < CMD_MSG_LEN; ++i)
+            cmds[n].msg[i] = slot->cmd.msg[i];
+
+        // hand the slot to the producer of the next lap
+        atomic_store_release32(&slot->seq, LAP(cmdq_tail) + CMD_QUEUE_LEN);
+        ++cmdq_tail;
+    }
+    if (n) {
+        cmdq_stats.dequeued += n;
+        cmdq_stats.batches++;
+        VERBOSE("dequeue %lu commands (tail %u)\r\n", n, cmdq_tail);
+    }
+    return n;
 }
 
 bool cmd_pending()
 {
-    return !(cmdq_head == cmdq_tail);
+    return atomic_load_acquire32(&cmdq[cmdq_tail % CMD_QUEUE_LEN].seq) ==
+           LAP(cmdq_tail) + 1;
+}
+
+void cmd_queue_get_stats(struct cmd_queue_stats *stats)
+{
+    stats->enqueued = cmdq_stats.enqueued;
+    stats->dequeued = cmdq_stats.dequeued;
+    stats->batches = cmdq_stats.batches;
+    stats->full = cmdq_stats.full;
+    stats->max_depth = cmdq_stats.max_depth;
 }
 
 void cmd_handle(struct cmd *cmd)
@@ -76,7 +148,8 @@ void cmd_handle(struct cmd *cmd)
     uint32_t reply[REPLY_SIZE];
     int reply_len;
     size_t rc;
-    unsigned sleep_ms_rem = CMD_TIMEOUT_MS_REPLY;
+    struct deadline d;
+    int i;
 
     VERBOSE("CMD handle cmd %x arg %x...\r\n", cmd->msg[0], cmd->msg[1]);
 
@@ -85,7 +158,7 @@ void cmd_handle(struct cmd *cmd)
         return;
     }
 
-    reply_len = cmd_handler(cmd, &reply[0], REPLY_SIZE - 1); // 1 word for header
+    reply_len = cmd_handler(cmd, &reply[0], REPLY_SIZE - 1); // 1 word for tag
 
     if (reply_len < 0) {
         WARN("ERROR: failed to process request: server error\r\n");
@@ -97,25 +170,32 @@ void cmd_handle(struct cmd *cmd)
         return;
     }
 
+    // let the client match the reply to its request
+    if (MBOX_LINK_IS_TAG(cmd->msg[MBOX_LINK_TAG_WORD])) {
+        for (i = reply_len; i < MBOX_LINK_TAG_WORD; ++i)
+            reply[i] = 0;
+        reply[MBOX_LINK_TAG_WORD] = cmd->msg[MBOX_LINK_TAG_WORD];
+        reply_len = MBOX_LINK_TAG_WORD + 1;
+    }
+
     rc = cmd->link->send(cmd->link, CMD_TIMEOUT_MS_SEND, reply,
                          reply_len * sizeof(uint32_t));
     if (!rc) {
         WARN("%s: failed to send reply\r\n", cmd->link->name);
     } else {
-        INFO("%s: waiting for ACK for our reply\r\n", cmd->link->name);
+        VERBOSE("%s: waiting for ACK for our reply\r\n", cmd->link->name);
+        deadline_init(&d, CMD_TIMEOUT_MS_REPLY);
         do {
             if (cmd->link->is_send_acked(cmd->link)) {
-                INFO("%s: ACK for our reply received\r\n", cmd->link->name);
+                VERBOSE("%s: ACK for our reply received\r\n", cmd->link->name);
                 break;
             }
-            if (sleep_ms_rem) {
-                mdelay(CMD_TIMEOUT_MS_RECV);
-                sleep_ms_rem -= sleep_ms_rem < CMD_TIMEOUT_MS_RECV ?
-                    sleep_ms_rem : CMD_TIMEOUT_MS_RECV;
-            } else {
-                WARN("%s: timed out waiting for ACK\r\n", cmd->link->name);
+            if (deadline_expired(&d)) {
+                WARN("%s: timed out waiting for ACK after %u ms\r\n",
+                     cmd->link->name, deadline_elapsed_ms(&d));
                 break;
             }
+            deadline_wait_event(&d);
         } while (1);
     }
 }
@@ -17,6 +17,7 @@
 #define CMD_MBOX_LINK_CONNECT           1000
 #define CMD_MBOX_LINK_DISCONNECT        1001
 #define CMD_MBOX_LINK_PING              1002
+#define CMD_SHMEM_DOORBELL              1003
 
 #define CMD_TIMEOUT_MS_SEND 1000
 #define CMD_TIMEOUT_MS_RECV 1000
@@ -35,8 +36,22 @@ void cmd_handler_unregister();
 
 void cmd_handle(struct cmd *cmd);
 
+// Back-pressure statistics of the command queue
+struct cmd_queue_stats {
+    volatile uint32_t enqueued;
+    volatile uint32_t dequeued;
+    volatile uint32_t batches;   // non-empty calls to cmd_dequeue_batch
+    volatile uint32_t full;      // commands dropped because the queue was full
+    volatile uint32_t max_depth; // high watermark of queued commands
+};
+
+// cmd_enqueue may be called concurrently from any core (e.g. mailbox ISRs);
+// there must be only one consumer.
 int cmd_enqueue(struct cmd *cmd);
 int cmd_dequeue(struct cmd *cmd);
+// returns the number of commands dequeued into cmds (at most max)
+size_t cmd_dequeue_batch(struct cmd *cmds, size_t max);
 bool cmd_pending();
+void cmd_queue_get_stats(struct cmd_queue_stats *stats);
 
 #endif // COMMAND_H
@@ -61,10 +61,10 @@ struct irq {
 
 struct gic {
     volatile uint32_t *base;
-    struct irq irqs[MAX_IRQS];
 };
 
 static struct gic gic = {0}; // support only one, to make the interface simpler
+OBJECT_POOL(irqs, struct irq, MAX_IRQS);
 
 static const char *irq_cfg_name(gic_irq_cfg_t t)
 {
@@ -167,7 +167,9 @@ void gic_disable_all()
 
 struct irq *gic_request(unsigned irqn, gic_irq_type_t type, gic_irq_cfg_t cfg)
 {
-    struct irq *irq = OBJECT_ALLOC(gic.irqs);
+    struct irq *irq = OBJECT_ALLOC(irqs);
+    if (!irq)
+        return NULL;
     irq->n = irqn;
     irq->type = type;
     irq->cfg = cfg;
@@ -176,7 +178,7 @@ struct irq *gic_request(unsigned irqn, gic_irq_type_t type, gic_irq_cfg_t cfg)
 
 void gic_release(struct irq *irq)
 {
-    OBJECT_FREE(irq);
+    OBJECT_FREE(irqs, irq);
 }
 
 static void gic_op_int_enable(struct irq *irq)
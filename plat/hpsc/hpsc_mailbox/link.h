@@ -8,6 +8,12 @@
 
 #include "object.h"
 
+// Progress of a request as seen by the link, in CNTPCT ticks (0 if unknown)
+struct link_req_times {
+    uint64_t sent;  // message handed to the remote
+    uint64_t acked; // remote took the message
+};
+
 /**
  * The link struct is effectively an API, which can be populated by other
  * link-like interfaces.
@@ -17,6 +23,7 @@ struct link {
     void *priv;
     const char *name;
     int (*disconnect)(struct link *link);
+    // Timeouts are in milliseconds; a negative timeout waits forever.
     // returns 0 on timeout, or positive value for number of bytes sent
     int (*send)(struct link *link, int timeout_ms, void *buf, size_t sz);
     bool (*is_send_acked)(struct link *link);
@@ -24,6 +31,17 @@ struct link {
     int (*request)(struct link *link,
                    int wtimeout_ms, void *wbuf, size_t wsz,
                    int rtimeout_ms, void *rbuf, size_t rsz);
+    // Split-phase request: request_async returns a positive tag once the
+    // message is handed to the remote, or -1 on send failure; the caller then
+    // collects the reply (into rbuf) with wait, which returns like request
+    // (-1 also if a request without reply was not taken by the remote) and
+    // fills times, if not NULL.
+    // Several requests may be outstanding on one link at a time.
+    int (*request_async)(struct link *link,
+                         int wtimeout_ms, void *wbuf, size_t wsz,
+                         void *rbuf, size_t rsz);
+    int (*wait)(struct link *link, int tag, int rtimeout_ms,
+                struct link_req_times *times);
     // recv not used for interrupt-based exchange mechanisms
     // returns 0 if no data, or number of bytes received
     int (*recv)(struct link *link, void *buf, size_t sz);
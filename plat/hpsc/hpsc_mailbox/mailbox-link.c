@@ -1,23 +1,46 @@
 #include <stdbool.h>
+#include <string.h>
+#include <arch_helpers.h>
 #include <platform.h>
 #include <mmio.h>
+#include <spinlock.h>
 
 #include "command.h"
 #include "link.h"
 #include "mailbox.h"
 #include "mailbox-link.h"
 #include "object.h"
+#include "sleep.h"
 #include <assert.h>
 //#include "panic.h"
 //#include "INFO.h"
 
+#ifdef HPSC_MBOX_LINKS
+#define MAX_LINKS HPSC_MBOX_LINKS
+#else
 #define MAX_LINKS 8
+#endif
+
+// Requests that may be in flight on one link at the same time
+#define MAX_OUTSTANDING PLATFORM_CORE_COUNT
 
 struct cmd_ctx {
-    volatile bool tx_acked;
+    volatile bool tx_acked; // also: the outgoing mailbox is free
+};
+
+struct req_ctx {
+    bool in_use;
+    volatile bool done;
+    bool timed_out;
+    bool want_reply;
+    struct deadline deadline;
+    int tag;
+    uint32_t seq;
     uint32_t *reply;
     size_t reply_sz;
     size_t reply_sz_read;
+    uint64_t sent_ts;
+    uint64_t ack_ts;
 };
 
 struct mbox_link {
@@ -27,17 +50,214 @@ struct mbox_link {
     struct mbox *mbox_from;
     struct mbox *mbox_to;
     struct cmd_ctx cmd_ctx;
+    spinlock_t lock; // protects the outstanding request state below
+    bool server;
+    uint32_t seq;
+    int tx_slot; // request whose message is not yet ACKed, or -1
+    // The remote echoes tags (see mailbox-link.h). Until a tagged reply is
+    // received, a reply can only be matched by being the one awaited: a lost
+    // or late reply would shift all later ones onto the wrong requests.
+    bool tags_echoed;
+    bool late_reply; // an untagged request timed out, its reply may follow
+    bool poller; // a waiter is polling the mailbox for events
+    // if set, mailbox events are consumed by the ISRs only (see mailbox-link.h)
+    void (*irq_poll)(void);
+    struct req_ctx reqs[MAX_OUTSTANDING];
 };
 
-static struct link links[MAX_LINKS] = {0};
-static struct mbox_link mlinks[MAX_LINKS] = {0};
+OBJECT_POOL(links, struct link, MAX_LINKS);
+OBJECT_POOL(mlinks, struct mbox_link, MAX_LINKS);
+
+static void req_complete(struct req_ctx *req)
+{
+    // publish the reply before the flag that waiters check
+    dmbish();
+    req->done = true;
+    dsbish();
+    sev();
+}
+
+static struct req_ctx *req_find(struct mbox_link *mlink, int tag)
+{
+    unsigned i;
+    for (i = 0; i < MAX_OUTSTANDING; ++i)
+        if (mlink->reqs[i].in_use && mlink->reqs[i].tag == tag)
+            return &mlink->reqs[i];
+    return NULL;
+}
+
+// Returns the request that waits for the reply whose tag word is given, or
+// NULL if the reply is stale, i.e. its request already timed out. Untagged
+// replies can only be for the one request that may wait for a reply.
+static struct req_ctx *req_match_reply(struct mbox_link *mlink, uint32_t word)
+{
+    struct req_ctx *req;
+    bool tagged = MBOX_LINK_IS_TAG(word);
+    int tag = word & MBOX_LINK_TAG_MAX;
+    unsigned i;
+
+    if (tagged) {
+        mlink->tags_echoed = true;
+    } else if (mlink->late_reply) {
+        // no request was sent since: the link is in sync again
+        mlink->late_reply = false;
+        return NULL;
+    }
+    for (i = 0; i < MAX_OUTSTANDING; ++i) {
+        req = &mlink->reqs[i];
+        if (!req->in_use || req->done || !req->want_reply)
+            continue;
+        if (!tagged || req->tag == tag)
+            return req;
+    }
+    return NULL;
+}
+
+// Whether a request for which the remote does not echo tags must wait for
+// the reply to the previous one
+static bool reply_pending_locked(struct mbox_link *mlink)
+{
+    struct req_ctx *req;
+    unsigned i;
+
+    if (mlink->tags_echoed)
+        return false;
+    if (mlink->late_reply)
+        return true;
+    for (i = 0; i < MAX_OUTSTANDING; ++i) {
+        req = &mlink->reqs[i];
+        if (req->in_use && !req->done && req->want_reply)
+            return true;
+    }
+    return false;
+}
+
+static void ack_locked(struct link *link)
+{
+    struct mbox_link *mlink = link->priv;
+    struct req_ctx *req;
+
+    mlink->cmd_ctx.tx_acked = true;
+    if (mlink->tx_slot < 0)
+        return;
+    req = &mlink->reqs[mlink->tx_slot];
+    mlink->tx_slot = -1;
+    req->ack_ts = read_cntpct_el0();
+    // requests without a reply are complete once the remote took the message
+    if (!req->want_reply)
+        req_complete(req);
+}
+
+static void reply_locked(struct link *link)
+{
+    struct mbox_link *mlink = link->priv;
+    uint32_t msg[HPSC_MBOX_DATA_REGS];
+    struct req_ctx *req;
+    size_t i;
+
+    mbox_read(mlink->mbox_from, msg, sizeof(msg));
+    req = req_match_reply(mlink, msg[MBOX_LINK_TAG_WORD]);
+    if (!req) {
+        WARN("%s: %s: no request waits for reply (tag word 0x%x)\r\n",
+             __func__, link->name, msg[MBOX_LINK_TAG_WORD]);
+        return;
+    }
+    for (i = 0; i < req->reply_sz && i < HPSC_MBOX_DATA_REGS; ++i)
+        req->reply[i] = msg[i];
+    req->reply_sz_read = i * sizeof(uint32_t);
+    req_complete(req);
+}
+
+static void expire_locked(struct link *link)
+{
+    struct mbox_link *mlink = link->priv;
+    struct req_ctx *req;
+    unsigned i;
+
+    for (i = 0; i < MAX_OUTSTANDING; ++i) {
+        req = &mlink->reqs[i];
+        if (!req->in_use || req->done || !deadline_expired(&req->deadline))
+            continue;
+        WARN("%s: %s: request %d timed out after %u ms\r\n", __func__,
+             link->name, req->tag, deadline_elapsed_ms(&req->deadline));
+        // the mailbox stays busy until the remote takes the message
+        if (mlink->tx_slot == (int)i)
+            mlink->tx_slot = -1;
+        if (req->want_reply && !mlink->tags_echoed)
+            mlink->late_reply = true;
+        req->timed_out = true;
+        req_complete(req);
+    }
+}
+
+// Dispatch mailbox events without relying on interrupts being taken, and
+// fail requests whose deadline passed
+static void progress_locked(struct link *link)
+{
+    struct mbox_link *mlink = link->priv;
+    if (mlink->irq_poll) {
+        // the ISRs take the lock
+        spin_unlock(&mlink->lock);
+        mlink->irq_poll();
+        spin_lock(&mlink->lock);
+    } else if (mbox_ack_pending(mlink->mbox_to)) {
+        mbox_clear_ack(mlink->mbox_to);
+        ack_locked(link);
+    }
+    if (!mlink->irq_poll && !mlink->server &&
+        mbox_rcv_pending(mlink->mbox_from)) {
+        mbox_clear_rcv(mlink->mbox_from);
+        reply_locked(link);
+    }
+    expire_locked(link);
+}
+
+// Wait until the outgoing mailbox is free and, for a request that expects a
+// reply, until no untagged reply is pending, with the lock held on entry and
+// on successful return. Returns false, with the lock released, on timeout.
+static bool wait_tx_locked(struct link *link, struct deadline *d,
+                           bool want_reply)
+{
+    struct mbox_link *mlink = link->priv;
+
+    while (!mlink->cmd_ctx.tx_acked ||
+           (want_reply && reply_pending_locked(mlink))) {
+        progress_locked(link);
+        if (mlink->cmd_ctx.tx_acked &&
+            !(want_reply && reply_pending_locked(mlink)))
+            break;
+        if (deadline_expired(d)) {
+            // no request waits for a reply (see reply_pending_locked): the
+            // reply to the one that timed out is lost rather than late
+            if (mlink->cmd_ctx.tx_acked && mlink->late_reply) {
+                WARN("%s: %s: no late reply in %u ms, assuming it is lost\r\n",
+                     __func__, link->name, deadline_elapsed_ms(d));
+                mlink->late_reply = false;
+                break;
+            }
+            spin_unlock(&mlink->lock);
+            if (!mlink->cmd_ctx.tx_acked)
+                WARN("%s: %s: remote did not take previous message in %u ms\r\n",
+                     __func__, link->name, deadline_elapsed_ms(d));
+            else
+                WARN("%s: %s: no reply to previous request in %u ms\r\n",
+                     __func__, link->name, deadline_elapsed_ms(d));
+            return false;
+        }
+        spin_unlock(&mlink->lock);
+        deadline_wait_event(d);
+        spin_lock(&mlink->lock);
+    }
+    return true;
+}
 
 static void handle_ack(void *arg)
 {
     struct link *link = arg;
     struct mbox_link *mlink = link->priv;
-    INFO("handle_ack: %s\r\n", link->name);
-    mlink->cmd_ctx.tx_acked = true;
+    spin_lock(&mlink->lock);
+    ack_locked(link);
+    spin_unlock(&mlink->lock);
 }
 
 static void handle_cmd(void *arg)
@@ -48,7 +268,6 @@ static void handle_cmd(void *arg)
     cmd.link = link;
     assert(sizeof(cmd.msg) == HPSC_MBOX_DATA_SIZE); // o/w zero-fill rest of msg
 
-    INFO("handle_cmd: %s\r\n", link->name);
     // read never fails if sizeof(cmd.msg) > 0
     mbox_read(mlink->mbox_from, cmd.msg, sizeof(cmd.msg));
     if (cmd_enqueue(&cmd))
@@ -59,10 +278,9 @@ static void handle_reply(void *arg)
 {
     struct link *link = arg;
     struct mbox_link *mlink = link->priv;
-    INFO("handle_reply: %s\r\n", link->name);
-    mlink->cmd_ctx.reply_sz_read = mbox_read(mlink->mbox_from,
-                                             mlink->cmd_ctx.reply,
-                                             mlink->cmd_ctx.reply_sz);
+    spin_lock(&mlink->lock);
+    reply_locked(link);
+    spin_unlock(&mlink->lock);
 }
 
 static int mbox_link_disconnect(struct link *link) {
@@ -72,76 +290,196 @@ static int mbox_link_disconnect(struct link *link) {
     // in case of failure, keep going and fwd code
     rc = mbox_release(mlink->mbox_from);
     rc |= mbox_release(mlink->mbox_to);
-    OBJECT_FREE(mlink);
-    OBJECT_FREE(link);
+    OBJECT_FREE(mlinks, mlink);
+    OBJECT_FREE(links, link);
     return rc;
 }
 
 static int mbox_link_send(struct link *link, int timeout_ms, void *buf,
                           size_t sz)
 {
-    // TODO: timeout
     struct mbox_link *mlink = link->priv;
+    struct deadline d;
+    int rc;
+
+    deadline_init(&d, timeout_ms);
+    spin_lock(&mlink->lock);
+    if (!wait_tx_locked(link, &d, false))
+        return 0;
     mlink->cmd_ctx.tx_acked = false;
     // INFO("mbox_link_send: %s\r\n", link->name);
-    return mbox_send(mlink->mbox_to, buf, sz);
+    rc = mbox_send(mlink->mbox_to, buf, sz);
+    spin_unlock(&mlink->lock);
+    return rc;
 }
 
 static bool mbox_link_is_send_acked(struct link *link)
 {
     struct mbox_link *mlink = link->priv;
+
+    if (mlink->cmd_ctx.tx_acked)
+        return true;
+    // don't depend on the ACK interrupt being routed to us
+    if (mlink->irq_poll) {
+        mlink->irq_poll();
+    } else if (mbox_ack_pending(mlink->mbox_to)) {
+        spin_lock(&mlink->lock);
+        if (mbox_ack_pending(mlink->mbox_to)) {
+            mbox_clear_ack(mlink->mbox_to);
+            ack_locked(link);
+        }
+        spin_unlock(&mlink->lock);
+    }
     return mlink->cmd_ctx.tx_acked;
 }
 
-static int mbox_link_poll(struct link *link, int timeout_ms)
+static int mbox_link_request_async(struct link *link,
+                                   int wtimeout_ms, void *wbuf, size_t wsz,
+                                   void *rbuf, size_t rsz)
 {
-    // TODO: timeout
     struct mbox_link *mlink = link->priv;
-    if(!mbox_get_rcv_poll(mlink->mbox_from))
-        WARN("%s: Didn't get ACK, the following mbox_read may be wrong\r\n", __func__);
-    mlink->cmd_ctx.reply_sz_read = mbox_read(mlink->mbox_from,
-                                             mlink->cmd_ctx.reply,
-                                             mlink->cmd_ctx.reply_sz);
-    WARN("%s: received (0x%lx) bytes\r\n", __func__, mlink->cmd_ctx.reply_sz_read);
-    mbox_clear_rcv(mlink->mbox_from);
-    return mlink->cmd_ctx.reply_sz_read;
+    uint32_t msg[HPSC_MBOX_DATA_REGS];
+    struct req_ctx *req = NULL;
+    struct deadline d;
+    unsigned i;
+
+    assert(wsz <= MBOX_LINK_TAG_WORD * sizeof(uint32_t));
+
+    // The mailbox holds one message at a time, so wait for the remote to
+    // take the previous one. Replies that arrive meanwhile are dispatched.
+    deadline_init(&d, wtimeout_ms);
+    spin_lock(&mlink->lock);
+    if (!wait_tx_locked(link, &d, rsz != 0))
+        return -1;
+
+    for (i = 0; i < MAX_OUTSTANDING && !req; ++i)
+        if (!mlink->reqs[i].in_use)
+            req = &mlink->reqs[i];
+    if (!req) {
+        spin_unlock(&mlink->lock);
+        WARN("%s: %s: too many outstanding requests\r\n", __func__, link->name);
+        return -1;
+    }
+
+    req->in_use = true;
+    req->done = false;
+    req->timed_out = false;
+    req->want_reply = (rsz != 0);
+    // until the caller waits, the request is bound by the send timeout,
+    // which waiting for the mailbox must not have used up
+    deadline_init(&req->deadline, wtimeout_ms);
+    req->seq = mlink->seq++;
+    req->tag = (req->seq % MBOX_LINK_TAG_MAX) + 1;
+    req->reply = rbuf;
+    req->reply_sz = rsz / sizeof(uint32_t);
+    req->reply_sz_read = 0;
+
+    memset(msg, 0, sizeof(msg));
+    memcpy(msg, wbuf, wsz);
+    msg[MBOX_LINK_TAG_WORD] = MBOX_LINK_TAG_MAGIC | req->tag;
+
+    mlink->tx_slot = req - mlink->reqs;
+    mlink->cmd_ctx.tx_acked = false;
+    if (!mbox_send(mlink->mbox_to, msg, sizeof(msg))) {
+        mlink->tx_slot = -1;
+        mlink->cmd_ctx.tx_acked = true;
+        req->in_use = false;
+        spin_unlock(&mlink->lock);
+        WARN("%s: %s: send failed\r\n", __func__, link->name);
+        return -1;
+    }
+    req->sent_ts = read_cntpct_el0();
+    req->ack_ts = 0;
+    spin_unlock(&mlink->lock);
+    return req->tag;
 }
 
-static int mbox_link_request(struct link *link,
-                             int wtimeout_ms, void *wbuf, size_t wsz,
-                             int rtimeout_ms, void *rbuf, size_t rsz)
+static int mbox_link_wait(struct link *link, int tag, int rtimeout_ms,
+                          struct link_req_times *times)
 {
     struct mbox_link *mlink = link->priv;
+    struct req_ctx *req;
+    bool polling;
     int rc;
 
-    // INFO("mbox_link_request: %s\r\n", link->name);
-    mlink->cmd_ctx.reply_sz_read = 0;
-    mlink->cmd_ctx.reply = rbuf;
-    mlink->cmd_ctx.reply_sz = rsz / sizeof(uint32_t);
-
-    rc = mbox_link_send(link, wtimeout_ms, wbuf, wsz);
-    if (!rc) {
-        WARN("%s: mbox_link_request: send failed\r\n", __func__);
+    spin_lock(&mlink->lock);
+    req = req_find(mlink, tag);
+    if (req && !req->done)
+        deadline_init(&req->deadline, rtimeout_ms);
+    spin_unlock(&mlink->lock);
+    if (!req) {
+        WARN("%s: %s: no outstanding request with tag %d\r\n", __func__,
+             link->name, tag);
         return -1;
     }
-    // TODO: timeout on ACKs as part of rtimeout_ms
-    // INFO("mbox_link_request: %s: waiting for ACK...\r\n", link->name);
 
-    /* Until TRCH server becomes stable, we just avoid infinite wait */
-   if (!mbox_get_ack_poll(mlink->mbox_to))
-        WARN("%s: Didn't get ACK, but ignores for now\r\n", __func__);
-    mbox_clear_ack(mlink->mbox_to);
-    // INFO("mbox_link_request: %s: ACK received\r\n", link->name);
+    // Interrupt-driven links: the ISR completes the request on whichever core
+    // takes the interrupt and wakes us with an event. Interrupts routed to
+    // this core are not taken in EL3, so each waiter services its own.
+    while (mlink->irq_poll && !req->done) {
+        mlink->irq_poll();
+        spin_lock(&mlink->lock);
+        expire_locked(link);
+        spin_unlock(&mlink->lock);
+        if (!req->done)
+            deadline_wait_event(&req->deadline);
+    }
+
+    // Otherwise, one waiter at a time polls the mailbox and completes (or
+    // expires) requests on behalf of all others, which sleep until it signals
+    // an event: either their request completed or the polling role is free.
+    while (!req->done) {
+        spin_lock(&mlink->lock);
+        polling = !mlink->poller;
+        mlink->poller = true;
+        spin_unlock(&mlink->lock);
+
+        if (!polling) {
+            deadline_wait_event(&req->deadline);
+            continue;
+        }
+
+        while (!req->done) {
+            spin_lock(&mlink->lock);
+            progress_locked(link);
+            spin_unlock(&mlink->lock);
+            if (!req->done)
+                deadline_wait_event(&req->deadline);
+        }
 
-    rc = rsz;
-    if (rsz) {
-        rc = mbox_link_poll(link, rtimeout_ms);
-        if (!rc)
-            WARN("%s: mbox_link_request: recv failed\r\n", __func__);
+        spin_lock(&mlink->lock);
+        mlink->poller = false;
+        spin_unlock(&mlink->lock);
+        sev();
     }
+
+    spin_lock(&mlink->lock);
+    // a request without reply that times out was never taken by the remote
+    rc = req->timed_out && !req->want_reply ? -1 : (int)req->reply_sz_read;
+    if (times) {
+        times->sent = req->sent_ts;
+        times->acked = req->ack_ts;
+    }
+    req->in_use = false;
+    spin_unlock(&mlink->lock);
+
+    if (req->want_reply && !rc)
+        WARN("%s: %s: recv failed\r\n", __func__, link->name);
     return rc;
 }
 
+static int mbox_link_request(struct link *link,
+                             int wtimeout_ms, void *wbuf, size_t wsz,
+                             int rtimeout_ms, void *rbuf, size_t rsz)
+{
+    int tag;
+
+    tag = mbox_link_request_async(link, wtimeout_ms, wbuf, wsz, rbuf, rsz);
+    if (tag < 0)
+        return -1;
+    return mbox_link_wait(link, tag, rtimeout_ms, NULL);
+}
+
 struct link *mbox_link_connect(
         const char *name,
         volatile uint32_t *base,
@@ -165,6 +503,7 @@ struct link *mbox_link_connect(
 
     mlink->idx_from = idx_from;
     mlink->idx_to = idx_to;
+    mlink->server = (server != 0);
 
     union mbox_cb rcv_cb = { .rcv_cb = server ? handle_cmd : handle_reply };
     mlink->mbox_from = mbox_claim(base, idx_from, rcv_irq, rcv_int_idx,
@@ -184,8 +523,8 @@ struct link *mbox_link_connect(
         goto free_from;
     }
 
-    mlink->cmd_ctx.tx_acked = false;
-    mlink->cmd_ctx.reply = NULL;
+    mlink->cmd_ctx.tx_acked = true;
+    mlink->tx_slot = -1;
 
     link->priv = mlink;
     link->name = name;
@@ -193,14 +532,25 @@ struct link *mbox_link_connect(
     link->send = mbox_link_send;
     link->is_send_acked = mbox_link_is_send_acked;
     link->request = mbox_link_request;
+    link->request_async = mbox_link_request_async;
+    link->wait = mbox_link_wait;
     link->recv = NULL;
     return link;
 
 free_from:
     mbox_release(mlink->mbox_from);
 free_links:
-    OBJECT_FREE(mlink);
+    OBJECT_FREE(mlinks, mlink);
 free_link:
-    OBJECT_FREE(link);
+    OBJECT_FREE(links, link);
     return NULL;
 }
+
+void mbox_link_set_irq_poll(struct link *link, void (*irq_poll)(void))
+{
+    struct mbox_link *mlink = link->priv;
+
+    spin_lock(&mlink->lock);
+    mlink->irq_poll = irq_poll;
+    spin_unlock(&mlink->lock);
+}
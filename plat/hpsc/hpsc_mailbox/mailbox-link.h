@@ -5,6 +5,20 @@
 
 #include "intc.h"
 #include "link.h"
+#include "mailbox.h"
+
+// The last data word of a request carries its tag, marked by
+// MBOX_LINK_TAG_MAGIC in the upper half. A server that echoes that word in
+// the same place of its reply (cmd_handle does) lets the client have several
+// requests waiting for replies at once. Otherwise, the client waits for the
+// reply to one request before it sends the next one that expects a reply.
+#define MBOX_LINK_TAG_WORD       (HPSC_MBOX_DATA_REGS - 1)
+#define MBOX_LINK_TAG_MAGIC      0x7a470000
+#define MBOX_LINK_TAG_MAGIC_MASK 0xffff0000
+#define MBOX_LINK_TAG_MAX        0xffff
+
+#define MBOX_LINK_IS_TAG(word) \
+    (((word) & MBOX_LINK_TAG_MAGIC_MASK) == MBOX_LINK_TAG_MAGIC)
 
 // We use 'owner' to indicate both the ID (arbitrary value) to which the
 // mailbox should be claimed (i.e. OWNER HW register should be set) and whether
@@ -22,4 +36,12 @@ struct link *mbox_link_connect(
         struct irq *ack_irq, unsigned ack_int_idx,
         unsigned server, unsigned client);
 
+// Make the link interrupt-driven: its mailbox events are consumed only by
+// mbox_rcv_isr/mbox_ack_isr, on whichever core takes the interrupts, and
+// waiters sleep until an ISR completes their request. Waiters call irq_poll
+// (with no lock held) to service the interrupts that are routed to their own
+// core but that cannot be taken while it waits, e.g. in EL3. Pass NULL to go
+// back to polling the mailbox.
+void mbox_link_set_irq_poll(struct link *link, void (*irq_poll)(void));
+
 #endif // MAILBOX_LINK_H
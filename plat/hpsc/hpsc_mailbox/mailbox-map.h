@@ -33,6 +33,24 @@
 #define MBOX_HPPS_TRCH__HPPS_ATF_TRCH 28
 #define MBOX_HPPS_TRCH__TRCH_ATF_HPPS 29
 
+// Per-core ATF links: the pair above belongs to CPU0, the others to CPU1-7.
+// ATF only claims them with HPSC_MBOX_PER_CORE=1, which needs a TRCH whose
+// copy of this file has them and whose server listens on them.
+#define MBOX_HPPS_TRCH__HPPS_ATF_TRCH_CPU1 14
+#define MBOX_HPPS_TRCH__TRCH_ATF_HPPS_CPU1 15
+#define MBOX_HPPS_TRCH__HPPS_ATF_TRCH_CPU2 16
+#define MBOX_HPPS_TRCH__TRCH_ATF_HPPS_CPU2 17
+#define MBOX_HPPS_TRCH__HPPS_ATF_TRCH_CPU3 18
+#define MBOX_HPPS_TRCH__TRCH_ATF_HPPS_CPU3 19
+#define MBOX_HPPS_TRCH__HPPS_ATF_TRCH_CPU4 20
+#define MBOX_HPPS_TRCH__TRCH_ATF_HPPS_CPU4 21
+#define MBOX_HPPS_TRCH__HPPS_ATF_TRCH_CPU5 22
+#define MBOX_HPPS_TRCH__TRCH_ATF_HPPS_CPU5 23
+#define MBOX_HPPS_TRCH__HPPS_ATF_TRCH_CPU6 24
+#define MBOX_HPPS_TRCH__TRCH_ATF_HPPS_CPU6 25
+#define MBOX_HPPS_TRCH__HPPS_ATF_TRCH_CPU7 26
+#define MBOX_HPPS_TRCH__TRCH_ATF_HPPS_CPU7 27
+
 #define MBOX_HPPS_TRCH__HPPS_TRCH_SSW 30
 #define MBOX_HPPS_TRCH__TRCH_HPPS_SSW 31
 
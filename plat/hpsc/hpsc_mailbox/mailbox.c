@@ -3,6 +3,7 @@
 #include <assert.h>
 #include <stdio.h>
 #include <gicv3.h>
+#include <mmio.h>
 #include <platform.h>
 
 // #include "INFO.h"
@@ -37,6 +38,7 @@
 #define HPSC_MBOX_INT_B(idx) (1 << (2 * (idx) + 1))  // ack (map event B to int 'idx')
 
 #define HPSC_MBOX_EVENTS 2
+#define HPSC_MBOX_EVENT_IDX(ev) ((ev) == HPSC_MBOX_EVENT_A ? 0 : 1)
 #define HPSC_MBOX_INTS   16
 #define HPSC_MBOX_INSTANCES 32
 #define HPSC_MBOX_INSTANCE_REGION (REG_DATA + HPSC_MBOX_DATA_SIZE)
@@ -44,11 +46,17 @@
 #define MAX_BLOCKS 2
 #define MAX_MBOXES (MAX_BLOCKS * HPSC_MBOX_INSTANCES)
 
+struct mbox;
+
 struct mbox_ip_block {
         struct object obj;
         volatile uint32_t *base;
         unsigned refcnt;
         unsigned irq_refcnt[HPSC_MBOX_EVENTS];
+        // Lookup for the ISR: claimed instances, and for each event and
+        // interrupt, the bitmap of instances that raise it
+        struct mbox *mboxes[HPSC_MBOX_INSTANCES];
+        uint32_t subscribed[HPSC_MBOX_EVENTS][HPSC_MBOX_INTS];
 };
 
 struct mbox {
@@ -59,14 +67,15 @@ struct mbox {
         int int_idx;
         struct irq *irq;
         bool owner; // whether this mailbox was claimed as owner
+        unsigned event; // the event this side handles (A: rcv, B: ack)
         union mbox_cb cb;
         void *cb_arg;
 };
 
-// The mboxes array is common across all mbox_ip_block's. We could let each
-// block own its own mboxes array, and iterate over blocks in the ISR. Meh.
-static struct mbox mboxes[MAX_MBOXES] = {0};
-static struct mbox_ip_block blocks[MAX_BLOCKS] = {0};
+// The mboxes pool is common across all mbox_ip_block's; each block keeps
+// pointers to its own mailboxes for the ISR.
+OBJECT_POOL(mboxes, struct mbox, MAX_MBOXES);
+OBJECT_POOL(blocks, struct mbox_ip_block, MAX_BLOCKS);
 
 static void mbox_irq_subscribe(struct mbox *mbox)
 {
@@ -84,8 +93,9 @@ static struct mbox_ip_block *block_get(volatile uint32_t *ip_base)
 {
     struct mbox_ip_block *b;
     unsigned block = 0;
+    // only called at claim time, over at most MAX_BLOCKS entries
     while (block < MAX_BLOCKS &&
-           (!blocks[block].obj.valid || blocks[block].base != ip_base))
+           (!blocks_objs[block].obj.valid || blocks_objs[block].base != ip_base))
         ++block;
     if (block == MAX_BLOCKS) { // no match
         b = OBJECT_ALLOC(blocks);
@@ -93,7 +103,7 @@ static struct mbox_ip_block *block_get(volatile uint32_t *ip_base)
             return NULL;
         b->base = ip_base;
     } else {
-        b = &blocks[block];
+        b = &blocks_objs[block];
     }
     ++b->refcnt;
     return b;
@@ -105,7 +115,7 @@ static void block_put(struct mbox_ip_block *b)
     if (!--b->refcnt) {
         for (unsigned e = 0; e < HPSC_MBOX_EVENTS; ++e)
             assert(!b->irq_refcnt[e]);
-        OBJECT_FREE(b);
+        OBJECT_FREE(blocks, b);
     }
 }
 
@@ -118,6 +128,9 @@ struct mbox *mbox_claim(volatile uint32_t * ip_base, unsigned instance,
            ip_base, instance, intc_int_type(irq), intc_int_num(irq),
            int_idx, owner, src, dest, dir);
 
+    assert(instance < HPSC_MBOX_INSTANCES);
+    assert(int_idx < HPSC_MBOX_INTS);
+
     struct mbox *m = OBJECT_ALLOC(mboxes);
     if (!m)
         return NULL;
@@ -140,8 +153,8 @@ struct mbox *mbox_claim(volatile uint32_t * ip_base, unsigned instance,
                        ((dest  << REG_CONFIG__DEST__SHIFT)  & REG_CONFIG__DEST__MASK);
         uint32_t val = config;
         INFO("mbox_claim: config: %p <|- %08x\r\n", addr, val);
-        *addr = val;
-        val = *addr;
+        mmio_write_32((uintptr_t)addr, val);
+        val = mmio_read_32((uintptr_t)addr);
         INFO("mbox_claim: config: %p -> %08x\r\n", addr, val);
         if (val != config) {
             INFO("mbox_claim: failed to claim mailbox %u for %x: already owned by %x\r\n",
@@ -150,7 +163,7 @@ struct mbox *mbox_claim(volatile uint32_t * ip_base, unsigned instance,
         }
     } else { // not owner, just check the value in registers against the requested value
         volatile uint32_t *addr = (volatile uint32_t *)((uint8_t *)m->base + REG_CONFIG);
-        uint32_t val = *addr;
+        uint32_t val = mmio_read_32((uintptr_t)addr);
         INFO("mbox_claim: config: %p -> %08x\r\n", addr, val);
         uint32_t src_hw =  (val & REG_CONFIG__SRC__MASK) >> REG_CONFIG__SRC__SHIFT;
         uint32_t dest_hw = (val & REG_CONFIG__DEST__MASK) >> REG_CONFIG__DEST__SHIFT;
@@ -181,12 +194,19 @@ struct mbox *mbox_claim(volatile uint32_t * ip_base, unsigned instance,
 
     volatile uint32_t *addr = (volatile uint32_t *)((uint8_t *)m->base + REG_INT_ENABLE);
     INFO("mbox_claim: int en: %p <|- %08x\r\n", addr, ie);
-    *addr |= ie;
+    mmio_setbits_32((uintptr_t)addr, ie);
     mbox_irq_subscribe(m);
 
+    assert(!m->block->mboxes[instance]);
+    m->block->mboxes[instance] = m;
+    m->event = dir == MBOX_INCOMING ? HPSC_MBOX_EVENT_A : HPSC_MBOX_EVENT_B;
+    m->block->subscribed[HPSC_MBOX_EVENT_IDX(m->event)][int_idx] |= 1u << instance;
+
     return m;
 cleanup:
-    OBJECT_FREE(m);
+    if (m->block)
+        block_put(m->block);
+    OBJECT_FREE(mboxes, m);
     return NULL;
 }
 
@@ -198,14 +218,17 @@ int mbox_release(struct mbox *m)
         volatile uint32_t *addr = (volatile uint32_t *)((uint8_t *)m->base + REG_CONFIG);
         uint32_t val = 0;
         INFO("mbox_release: owner: %p <|- %08x\r\n", addr, val);
-        *addr = val;
+        mmio_write_32((uintptr_t)addr, val);
 
         // clearing owner also clears destination (resets the instance)
     }
 
+    m->block->subscribed[HPSC_MBOX_EVENT_IDX(m->event)][m->int_idx] &=
+        ~(1u << m->instance);
+    m->block->mboxes[m->instance] = NULL;
     mbox_irq_unsubscribe(m);
     block_put(m->block);
-    OBJECT_FREE(m);
+    OBJECT_FREE(mboxes, m);
     return 0;
 }
 
@@ -220,15 +243,15 @@ size_t mbox_send(struct mbox *m, void *buf, size_t sz)
 
     volatile uint32_t *slot = (volatile uint32_t *)((uint8_t *)m->base + REG_DATA);
     for (i = 0; i < len; ++i) {
-        slot[i] = msg[i];
+        mmio_write_32((uintptr_t)&slot[i], msg[i]);
     }
     // zero out any remaining registers
     for (; i < HPSC_MBOX_DATA_REGS; i++)
-        slot[i] = 0;
+        mmio_write_32((uintptr_t)&slot[i], 0);
 
     volatile uint32_t *addr = (volatile uint32_t *)((uint8_t *)m->base + REG_EVENT_SET);
     uint32_t val = HPSC_MBOX_EVENT_A;
-    *addr = val;
+    mmio_write_32((uintptr_t)addr, val);
 
     return sz;
 }
@@ -243,18 +266,14 @@ size_t mbox_read(struct mbox *m, void *buf, size_t sz)
     if (sz % sizeof(uint32_t))
         len++;
 
-    INFO("mbox_read: msg: ");
-    for (i = 0; i < len && i < HPSC_MBOX_DATA_REGS; i++) {
-        msg[i] = *data++;
-        INFO("%x ", msg[i]);
-    }
-    INFO("\r\n");
+    for (i = 0; i < len && i < HPSC_MBOX_DATA_REGS; i++)
+        msg[i] = mmio_read_32((uintptr_t)data++);
+    VERBOSE("mbox_read: instance %u: msg %x...\r\n", m->instance, msg[0]);
 
     // ACK
     volatile uint32_t *addr = (volatile uint32_t *)((uint8_t *)m->base + REG_EVENT_SET);
     uint32_t val = HPSC_MBOX_EVENT_B;
-    INFO("mbox_read: set int B: %p <- %08x\r\n", addr, val);
-    *addr = val;
+    mmio_write_32((uintptr_t)addr, val);
 
     return i * sizeof(uint32_t);
 }
@@ -264,42 +283,29 @@ static void mbox_instance_rcv_isr(struct mbox *mbox)
     volatile uint32_t *addr;
     uint32_t val;
 
-    INFO("mbox_instance_rcv_isr: base %p instance %u\r\n", mbox->base, mbox->instance);
+    VERBOSE("mbox_instance_rcv_isr: base %p instance %u\r\n", mbox->base, mbox->instance);
 
     // Clear the event
     addr = (volatile uint32_t *)((uint8_t *)mbox->base + REG_EVENT_CLEAR);
     val = HPSC_MBOX_EVENT_A;
-    INFO("mbox_instance_rcv_isr: clear int A: %p <- %08x\r\n", addr, val);
-    *addr = val;
+    mmio_write_32((uintptr_t)addr, val);
 
     if (mbox->cb.rcv_cb)
         mbox->cb.rcv_cb(mbox->cb_arg);
 }
 
-/* Todo: replace with sleep */
-static int busy_wait()
+bool mbox_rcv_pending(struct mbox *mbox)
 {
-    int i, j;
-    for(i = j = 0; i < 1000; i++) {
-       j += i * (i - 2);
-    }
-    return j;
+    volatile uint32_t *addr;
+    addr = (volatile uint32_t *)((uint8_t *)mbox->base + REG_EVENT_STATUS);
+    return (mmio_read_32((uintptr_t)addr) & HPSC_MBOX_EVENT_A) != 0;
 }
 
-bool mbox_get_rcv_poll(struct mbox * mbox)
+bool mbox_ack_pending(struct mbox *mbox)
 {
-    uint32_t * addr = (uint32_t *)((uint8_t *)mbox->base + REG_EVENT_STATUS);
-    uint32_t val;
-    int i;
-    for (i = 0; i < 1000000000; i++) {
-        if (i > 0 && i % 100 == 0) printf("\r");	/* to give Qemu a chance to do context changes */
-        val = (* addr) & HPSC_MBOX_EVENT_A;
-        if (val != 0) return true;
-        busy_wait();
-    }
-    val = (* addr) & HPSC_MBOX_EVENT_A;
-    if (!val) WARN("%s: timeout, event_status(0x%x), val(0x%x)\n", __func__, *addr, val);
-    return (val != 0);
+    volatile uint32_t *addr;
+    addr = (volatile uint32_t *)((uint8_t *)mbox->base + REG_EVENT_STATUS);
+    return (mmio_read_32((uintptr_t)addr) & HPSC_MBOX_EVENT_B) != 0;
 }
 
 void mbox_clear_rcv(struct mbox * mbox)
@@ -308,23 +314,7 @@ void mbox_clear_rcv(struct mbox * mbox)
     uint32_t val;
     addr = (volatile uint32_t *)((uint8_t *)mbox->base + REG_EVENT_CLEAR);
     val = HPSC_MBOX_EVENT_A;
-    *addr = val;
-}
-
-bool mbox_get_ack_poll(struct mbox * mbox)
-{
-    volatile uint32_t * addr;
-    uint32_t val;
-    int i;
-    addr = (volatile uint32_t *)((uint8_t *)mbox->base + REG_EVENT_STATUS);
-    for (i = 0; i < 1000000000; i++) {
-        if (i > 0 && i % 100 == 0) printf("\r");	/* to give Qemu a chance to do context changes */
-        val = (* addr) & HPSC_MBOX_EVENT_B;
-        if (val != 0) return true;
-        busy_wait();
-    }
-    val = (* addr) & HPSC_MBOX_EVENT_B;
-    return (val != 0);
+    mmio_write_32((uintptr_t)addr, val);
 }
 
 void mbox_clear_ack(struct mbox * mbox)
@@ -333,7 +323,7 @@ void mbox_clear_ack(struct mbox * mbox)
     uint32_t val;
     addr = (volatile uint32_t *)((uint8_t *)mbox->base + REG_EVENT_CLEAR);
     val = HPSC_MBOX_EVENT_B;
-    *addr = val;
+    mmio_write_32((uintptr_t)addr, val);
 }
 
 static void mbox_instance_ack_isr(struct mbox *mbox)
@@ -342,69 +332,59 @@ static void mbox_instance_ack_isr(struct mbox *mbox)
     volatile uint32_t *addr;
     uint32_t val;
 
-    INFO("mbox_instance_ack_isr: base %p instance %u\r\n", mbox->base, mbox->instance);
+    VERBOSE("mbox_instance_ack_isr: base %p instance %u\r\n", mbox->base, mbox->instance);
 
     // Clear the event first
     addr = (volatile uint32_t *)((uint8_t *)mbox->base + REG_EVENT_CLEAR);
     val = HPSC_MBOX_EVENT_B;
-    INFO("mbox_instance_ack_isr: clear int B: %p <- %08x\r\n", addr, val);
-    *addr = val;
+    mmio_write_32((uintptr_t)addr, val);
 
     if (mbox->cb.ack_cb)
         mbox->cb.ack_cb(mbox->cb_arg);
 
 }
 
-static void mbox_isr(unsigned event, unsigned interrupt)
+static void mbox_isr(unsigned event, unsigned int_idx)
 {
     volatile uint32_t *addr;
-    uint32_t val;
+    struct mbox_ip_block *b;
     struct mbox *mbox;
-    unsigned i;
+    uint32_t pending;
+    unsigned block, i;
     bool handled = false;
-    // Technically, could iterate only over one IP block if we care to split
-    // the main mailbox array into multiple arrays, one per block.
-    for (i = 0; i < MAX_MBOXES; ++i) {
-        mbox = &mboxes[i];
-        if (!mbox->obj.valid)
-            continue;
 
-        // Are we 'signed up' for this event (A) from this mailbox (i)?
-        // Two criteria: (1) Cause is set, and (2) Mapped to our IRQ
-        addr = (volatile uint32_t *)((uint8_t *)mbox->base + REG_EVENT_CAUSE);
-        val = *addr;
-        INFO("mbox_isr: cause: %p -> %08x\r\n", addr, val);
-        if (!(val & event))
-            continue; // this mailbox didn't raise the interrupt
-        addr = (volatile uint32_t *)((uint8_t *)mbox->base + REG_INT_ENABLE);
-        val = *addr;
-        INFO("mbox_isr: int enable: %p -> %08x\r\n", addr, val);
-        if (!(val & interrupt))
-            continue; // this mailbox has an event but it's not ours
-
-        handled = true;
-
-        switch (event) {
-            case HPSC_MBOX_EVENT_A:
+    assert(int_idx < HPSC_MBOX_INTS);
+    // Only the instances that map this event to this interrupt are checked
+    for (block = 0; block < MAX_BLOCKS; ++block) {
+        b = &blocks_objs[block];
+        if (!b->obj.valid)
+            continue;
+        pending = b->subscribed[HPSC_MBOX_EVENT_IDX(event)][int_idx];
+        while (pending) {
+            i = __builtin_ctz(pending);
+            pending &= pending - 1;
+            mbox = b->mboxes[i];
+
+            addr = (volatile uint32_t *)((uint8_t *)mbox->base + REG_EVENT_CAUSE);
+            if (!(mmio_read_32((uintptr_t)addr) & event))
+                continue; // this mailbox didn't raise the interrupt
+
+            handled = true;
+            if (event == HPSC_MBOX_EVENT_A)
                 mbox_instance_rcv_isr(mbox);
-                break;
-            case HPSC_MBOX_EVENT_B:
+            else
                 mbox_instance_ack_isr(mbox);
-                break;
-            default:
-                INFO("ERROR: mbox_isr: invalid event %u\r\n", event);
-                assert(false && "invalid event");
         }
-   }
-   if (!handled) INFO("PANIC: %s: is not handled\n", __func__);
-   assert(handled); // otherwise, we're not correctly subscribed to interrupts
+    }
+    if (!handled) INFO("PANIC: %s: is not handled\n", __func__);
+    assert(handled); // otherwise, we're not correctly subscribed to interrupts
 }
 
 void mbox_rcv_isr(unsigned int_idx)
 {
-    mbox_isr(HPSC_MBOX_EVENT_A, HPSC_MBOX_INT_A(int_idx));
+    mbox_isr(HPSC_MBOX_EVENT_A, int_idx);
 }
 void mbox_ack_isr(unsigned int_idx)
 {
-    mbox_isr(HPSC_MBOX_EVENT_B, HPSC_MBOX_INT_B(int_idx));
+    mbox_isr(HPSC_MBOX_EVENT_B, int_idx);
 }
@@ -34,8 +34,10 @@ struct mbox *mbox_claim(volatile uint32_t * ip_base, unsigned instance,
 int mbox_release(struct mbox *m);
 size_t mbox_send(struct mbox *m, void *buf, size_t sz);
 size_t mbox_read(struct mbox *m, void *buf, size_t sz);
-bool mbox_get_ack_poll(struct mbox * mbox);
-bool mbox_get_rcv_poll(struct mbox * mbox);
+// Non-blocking checks of the event status, for callers that drive the
+// mailbox without interrupts (e.g. from a wait loop)
+bool mbox_rcv_pending(struct mbox *mbox);
+bool mbox_ack_pending(struct mbox *mbox);
 void mbox_clear_ack(struct mbox * mbox);
 void mbox_clear_rcv(struct mbox * mbox);
 
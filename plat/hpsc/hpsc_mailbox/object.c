@@ -1,4 +1,3 @@
-
 #include <stdint.h>
 #include <stdio.h>
 #include <assert.h>
@@ -6,26 +5,52 @@
 #include "mem.h"
 #include "object.h"
 
-void *object_alloc(const char *name, void *array, unsigned elems, unsigned sz)
+#define OBJECT_AT(pool, idx) \
+    ((struct object *)((uint8_t *)(pool)->array + (idx) * (pool)->sz))
+
+void *object_alloc(struct object_pool *pool)
 {
-    unsigned idx = 0;
-    while (idx < elems &&
-            ((struct object *)((uint8_t *)array + idx * sz))->valid)
-        ++idx;
-    if (idx == elems) {
-        WARN("%s: ERROR: failed to alloc object %s: out of mem\r\n", __func__, name);
+    struct object *obj;
+    unsigned idx;
+
+    if (pool->free_head) {
+        idx = pool->free_head - 1;
+        obj = OBJECT_AT(pool, idx);
+        pool->free_head = obj->index;
+    } else if (pool->fresh < pool->elems) {
+        idx = pool->fresh++;
+        obj = OBJECT_AT(pool, idx);
+    } else {
+        pool->stats.fails++;
+        WARN("%s: ERROR: failed to alloc object %s: out of mem (%u in use)\r\n",
+             __func__, pool->name, pool->stats.used);
         return NULL;
     }
-    INFO("OBJECT: alloced obj %s of sz %u\r\n", name, sz);
-    struct object *obj = (struct object *)((uint8_t *)array + idx * sz);
-    bzero(obj, sz);
+    INFO("OBJECT: alloced obj %s of sz %u\r\n", pool->name, pool->sz);
+    bzero(obj, pool->sz);
     obj->valid = 1;
     assert(idx <= ~(typeof(obj->index))0);
     obj->index = idx;
+
+    pool->stats.allocs++;
+    if (++pool->stats.used > pool->stats.max_used)
+        pool->stats.max_used = pool->stats.used;
     return obj;
 }
 
-void object_free(void *obj, unsigned sz)
+void object_free(struct object_pool *pool, void *p)
 {
-    bzero(obj, sz);
+    struct object *obj = p;
+    unsigned idx = obj->index;
+
+    assert(obj->valid);
+    assert(OBJECT_AT(pool, idx) == obj);
+    bzero(obj, pool->sz);
+    // push on the free list
+    obj->index = pool->free_head;
+    assert(idx + 1 <= ~(typeof(obj->index))0);
+    pool->free_head = idx + 1;
+
+    pool->stats.frees++;
+    pool->stats.used--;
 }
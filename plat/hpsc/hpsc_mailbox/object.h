@@ -13,16 +13,44 @@
 //   };
 struct object { // keep the metadata to one word
     uint16_t valid;
-    uint16_t index;
+    uint16_t index; // while free: next free object + 1, or 0
 };
 
-// NOTE: 'array' must be an array type, not a pointer
-#define OBJECT_ALLOC(array) (typeof(array[0]) *)object_alloc(#array, array, \
-                            (sizeof(array) / sizeof(array[0])), sizeof(array[0]))
-#define OBJECT_FREE(obj) object_free(obj, sizeof(*obj))
+struct object_pool_stats {
+    unsigned allocs;
+    unsigned frees;
+    unsigned fails;
+    unsigned used;
+    unsigned max_used;
+};
+
+// A pool hands out the objects of a static array in constant time: objects
+// that were never used are taken in order, freed ones are kept on a list
+// threaded through their metadata. A zero-initialized pool is empty and
+// ready for use. Pools are not thread-safe: objects are allocated and freed
+// while the platform is being set up, on one core.
+struct object_pool {
+    const char *name;
+    void *array;
+    unsigned elems;
+    unsigned sz;
+    unsigned fresh;     // first object that was never allocated
+    unsigned free_head; // first freed object + 1, or 0
+    struct object_pool_stats stats;
+};
+
+// Define a (file-local) pool of 'n' objects of type 'type'
+#define OBJECT_POOL(pool, type, n) \
+    static type pool##_objs[n]; \
+    static struct object_pool pool = { \
+        .name = #pool, .array = pool##_objs, .elems = (n), .sz = sizeof(type) }
+
+#define OBJECT_ALLOC(pool) ((typeof(pool##_objs[0]) *)object_alloc(&(pool)))
+// The conditional makes the compiler check that obj belongs to the pool type
+#define OBJECT_FREE(pool, obj) object_free(&(pool), 1 ? (obj) : pool##_objs)
 
 // Not for cosumer use -- use the above macros
-void *object_alloc(const char *name, void *array, unsigned elems, unsigned sz);
-void object_free(void *obj, unsigned sz);
+void *object_alloc(struct object_pool *pool);
+void object_free(struct object_pool *pool, void *obj);
 
 #endif // OBJECT_H
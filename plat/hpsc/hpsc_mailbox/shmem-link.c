@@ -0,0 +1,473 @@
+#include <stdbool.h>
+#include <string.h>
+#include <arch_helpers.h>
+#include <assert.h>
+#include <debug.h>
+#include <platform.h>
+#include <spinlock.h>
+
+#include "command.h"
+#include "link.h"
+#include "object.h"
+#include "shmem-link.h"
+#include "sleep.h"
+
+#define MAX_LINKS 2
+
+#define SHMEM_MAGIC 0x4853484d // "HSHM"
+#define SHMEM_VERSION 1
+#define SHMEM_SLOTS 8          // per ring, power of two
+#define SHMEM_ALIGN 64         // keep data written by each side in own lines
+
+// Requests that may wait for a reply at the same time
+#define MAX_OUTSTANDING PLATFORM_CORE_COUNT
+
+// Shared region layout (all fields little-endian words):
+//   struct shmem_hdr | request slot payloads | reply slot payloads
+// The producer of a ring writes its 'head' and the descriptors, the consumer
+// writes its 'tail'. A descriptor's tag pairs a reply with its request; the
+// remote echoes the tag of the request in the reply descriptor.
+struct shmem_idx {
+    volatile uint32_t val;
+} __aligned(SHMEM_ALIGN);
+
+struct shmem_desc {
+    uint32_t tag;
+    uint32_t size;
+};
+
+struct shmem_ring {
+    struct shmem_idx head;
+    struct shmem_idx tail;
+    struct shmem_desc desc[SHMEM_SLOTS];
+} __aligned(SHMEM_ALIGN);
+
+struct shmem_hdr {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t slots;
+    uint32_t slot_size;
+    struct shmem_ring req; // local -> remote
+    struct shmem_ring rep; // remote -> local
+} __aligned(SHMEM_ALIGN);
+
+struct req_ctx {
+    bool in_use;
+    volatile bool done;
+    bool timed_out;
+    bool want_reply;
+    uint32_t pos; // request slot
+    int tag;
+    void *reply;
+    size_t reply_sz;
+    size_t reply_sz_read;
+    uint64_t sent_ts;
+};
+
+struct shmem_link {
+    struct object obj;
+    struct link *doorbell;
+    struct shmem_hdr *hdr;
+    uint8_t *req_data;
+    uint8_t *rep_data;
+    size_t slot_size;
+    spinlock_t lock; // protects the fields below
+    uint32_t alloc;  // next request slot to reserve (published head <= alloc)
+    bool committed[SHMEM_SLOTS];
+    uint32_t seq;
+    struct req_ctx reqs[MAX_OUTSTANDING];
+};
+
+OBJECT_POOL(links, struct link, MAX_LINKS);
+OBJECT_POOL(slinks, struct shmem_link, MAX_LINKS);
+
+static void *req_slot(struct shmem_link *slink, uint32_t pos)
+{
+    return slink->req_data + (pos % SHMEM_SLOTS) * slink->slot_size;
+}
+
+static void *rep_slot(struct shmem_link *slink, uint32_t pos)
+{
+    return slink->rep_data + (pos % SHMEM_SLOTS) * slink->slot_size;
+}
+
+// Returns the position of the slot whose payload is buf, or -1
+static int tx_slot_of(struct shmem_link *slink, const void *buf)
+{
+    uintptr_t off = (uintptr_t)buf - (uintptr_t)slink->req_data;
+    if ((uintptr_t)buf < (uintptr_t)slink->req_data ||
+        off >= SHMEM_SLOTS * slink->slot_size || off % slink->slot_size)
+        return -1;
+    return off / slink->slot_size;
+}
+
+static bool tx_reserve_locked(struct shmem_link *slink, uint32_t *pos)
+{
+    if (slink->alloc - slink->hdr->req.tail.val >= SHMEM_SLOTS)
+        return false;
+    *pos = slink->alloc++;
+    return true;
+}
+
+// Publish a filled request slot. Slots reserved earlier but not filled yet
+// hold back the head, so the remote sees requests in reservation order.
+static bool tx_commit_locked(struct shmem_link *slink, uint32_t pos,
+                             uint32_t tag, size_t sz)
+{
+    struct shmem_ring *ring = &slink->hdr->req;
+    uint32_t head = ring->head.val;
+
+    ring->desc[pos % SHMEM_SLOTS].tag = tag;
+    ring->desc[pos % SHMEM_SLOTS].size = sz;
+    slink->committed[pos % SHMEM_SLOTS] = true;
+
+    while (head != slink->alloc && slink->committed[head % SHMEM_SLOTS]) {
+        slink->committed[head % SHMEM_SLOTS] = false;
+        ++head;
+    }
+    if (head == ring->head.val)
+        return false;
+
+    // payload and descriptors before the index that publishes them
+    dmbst();
+    ring->head.val = head;
+    dsbsy();
+    return true;
+}
+
+static int ring_doorbell(struct link *link, int timeout_ms)
+{
+    struct shmem_link *slink = link->priv;
+    uint32_t msg[2] = { CMD_SHMEM_DOORBELL, slink->hdr->req.head.val };
+
+    return slink->doorbell->request(slink->doorbell, timeout_ms,
+                                    msg, sizeof(msg), timeout_ms, NULL, 0);
+}
+
+// Returns the position that a slot reserved by shmem_link_tx_alloc, and not
+// committed yet, belongs to
+static uint32_t tx_alloc_pos_locked(struct shmem_link *slink, int slot)
+{
+    uint32_t pos = slink->alloc - 1;
+    while (pos % SHMEM_SLOTS != (unsigned)slot)
+        --pos;
+    return pos;
+}
+
+// Reserve a slot, waiting for the remote to drain the ring, and copy the
+// payload into it unless the caller filled it in place
+static int tx_prepare(struct link *link, int timeout_ms, void *buf,
+                      size_t sz, uint32_t *pos)
+{
+    struct shmem_link *slink = link->priv;
+    struct deadline d;
+    int slot;
+
+    if (sz > slink->slot_size)
+        return -1;
+
+    slot = tx_slot_of(slink, buf);
+    if (slot >= 0) {
+        spin_lock(&slink->lock);
+        *pos = tx_alloc_pos_locked(slink, slot);
+        spin_unlock(&slink->lock);
+        return 0;
+    }
+
+    deadline_init(&d, timeout_ms);
+    spin_lock(&slink->lock);
+    while (!tx_reserve_locked(slink, pos)) {
+        spin_unlock(&slink->lock);
+        if (deadline_expired(&d)) {
+            WARN("%s: %s: request ring full for %u ms\r\n", __func__,
+                 link->name, deadline_elapsed_ms(&d));
+            return -1;
+        }
+        deadline_wait_event(&d);
+        spin_lock(&slink->lock);
+    }
+    spin_unlock(&slink->lock);
+
+    memcpy(req_slot(slink, *pos), buf, sz);
+    return 0;
+}
+
+static struct req_ctx *req_find(struct shmem_link *slink, int tag)
+{
+    unsigned i;
+    for (i = 0; i < MAX_OUTSTANDING; ++i)
+        if (slink->reqs[i].in_use && slink->reqs[i].tag == tag)
+            return &slink->reqs[i];
+    return NULL;
+}
+
+// Requests without a reply are complete once the remote consumed their slot
+static void tx_complete_locked(struct shmem_link *slink)
+{
+    uint32_t tail = slink->hdr->req.tail.val;
+    struct req_ctx *req;
+    unsigned i;
+
+    for (i = 0; i < MAX_OUTSTANDING; ++i) {
+        req = &slink->reqs[i];
+        if (req->in_use && !req->done && !req->want_reply &&
+            (int32_t)(tail - req->pos) > 0)
+            req->done = true;
+    }
+}
+
+// Consume all entries of the reply ring and complete their requests
+static void rx_drain_locked(struct link *link)
+{
+    struct shmem_link *slink = link->priv;
+    struct shmem_ring *ring = &slink->hdr->rep;
+    uint32_t tail = ring->tail.val;
+    struct shmem_desc *desc;
+    struct req_ctx *req;
+    size_t sz;
+
+    while (tail != ring->head.val) {
+        dmbld();
+        desc = &ring->desc[tail % SHMEM_SLOTS];
+        req = req_find(slink, desc->tag);
+        if (!req || req->done) {
+            WARN("%s: %s: no request waits for reply (tag %u)\r\n", __func__,
+                 link->name, desc->tag);
+        } else {
+            sz = desc->size < req->reply_sz ? desc->size : req->reply_sz;
+            memcpy(req->reply, rep_slot(slink, tail), sz);
+            req->reply_sz_read = sz;
+            req->done = true;
+        }
+        ++tail;
+    }
+    // done with the payloads before handing the slots back
+    dmbsy();
+    ring->tail.val = tail;
+    dsbsy();
+}
+
+static int shmem_link_disconnect(struct link *link)
+{
+    struct shmem_link *slink = link->priv;
+    INFO("shmem_link_disconnect: %s\r\n", link->name);
+    slink->hdr->magic = 0;
+    dsbsy();
+    OBJECT_FREE(slinks, slink);
+    OBJECT_FREE(links, link);
+    return 0;
+}
+
+static int shmem_link_send(struct link *link, int timeout_ms, void *buf,
+                           size_t sz)
+{
+    struct shmem_link *slink = link->priv;
+    uint32_t pos;
+    bool publish;
+
+    if (tx_prepare(link, timeout_ms, buf, sz, &pos))
+        return 0;
+    spin_lock(&slink->lock);
+    publish = tx_commit_locked(slink, pos, 0, sz);
+    spin_unlock(&slink->lock);
+    if (publish && ring_doorbell(link, timeout_ms) < 0)
+        return 0;
+    return sz;
+}
+
+static bool shmem_link_is_send_acked(struct link *link)
+{
+    struct shmem_link *slink = link->priv;
+    return slink->hdr->req.tail.val == slink->hdr->req.head.val;
+}
+
+static int shmem_link_request_async(struct link *link,
+                                    int wtimeout_ms, void *wbuf, size_t wsz,
+                                    void *rbuf, size_t rsz)
+{
+    struct shmem_link *slink = link->priv;
+    struct req_ctx *req = NULL;
+    uint32_t pos;
+    unsigned i;
+    bool publish;
+
+    if (tx_prepare(link, wtimeout_ms, wbuf, wsz, &pos))
+        return -1;
+
+    spin_lock(&slink->lock);
+    for (i = 0; i < MAX_OUTSTANDING && !req; ++i)
+        if (!slink->reqs[i].in_use)
+            req = &slink->reqs[i];
+    if (!req) {
+        // hand the slot over as an empty message, to keep the ring moving
+        publish = tx_commit_locked(slink, pos, 0, 0);
+        spin_unlock(&slink->lock);
+        WARN("%s: %s: too many outstanding requests\r\n", __func__, link->name);
+        // requests held back by the slot may have been published
+        if (publish)
+            ring_doorbell(link, wtimeout_ms);
+        return -1;
+    }
+    req->in_use = true;
+    req->done = false;
+    req->timed_out = false;
+    req->want_reply = rbuf && rsz;
+    req->pos = pos;
+    req->tag = (slink->seq++ % 0x7fffffff) + 1;
+    req->reply = rbuf;
+    req->reply_sz = req->want_reply ? rsz : 0;
+    req->reply_sz_read = 0;
+    publish = tx_commit_locked(slink, pos, req->tag, wsz);
+    req->sent_ts = read_cntpct_el0();
+    spin_unlock(&slink->lock);
+
+    if (publish && ring_doorbell(link, wtimeout_ms) < 0) {
+        spin_lock(&slink->lock);
+        req->in_use = false;
+        spin_unlock(&slink->lock);
+        return -1;
+    }
+    return req->tag;
+}
+
+static int shmem_link_wait(struct link *link, int tag, int rtimeout_ms,
+                           struct link_req_times *times)
+{
+    struct shmem_link *slink = link->priv;
+    struct req_ctx *req;
+    struct deadline d;
+    int rc;
+
+    spin_lock(&slink->lock);
+    req = req_find(slink, tag);
+    spin_unlock(&slink->lock);
+    if (!req)
+        return -1;
+
+    deadline_init(&d, rtimeout_ms);
+    while (!req->done) {
+        spin_lock(&slink->lock);
+        tx_complete_locked(slink);
+        rx_drain_locked(link);
+        spin_unlock(&slink->lock);
+        if (req->done)
+            break;
+        if (deadline_expired(&d)) {
+            WARN("%s: %s: request %d timed out after %u ms\r\n", __func__,
+                 link->name, tag, deadline_elapsed_ms(&d));
+            req->timed_out = true;
+            break;
+        }
+        deadline_wait_event(&d);
+    }
+
+    spin_lock(&slink->lock);
+    // a request without reply that times out was never taken by the remote
+    rc = req->timed_out && !req->want_reply ? -1 : (int)req->reply_sz_read;
+    if (times) {
+        // the remote takes messages off the ring without acknowledging them
+        times->sent = req->sent_ts;
+        times->acked = 0;
+    }
+    req->in_use = false;
+    spin_unlock(&slink->lock);
+    return rc;
+}
+
+static int shmem_link_request(struct link *link,
+                              int wtimeout_ms, void *wbuf, size_t wsz,
+                              int rtimeout_ms, void *rbuf, size_t rsz)
+{
+    int tag;
+
+    tag = shmem_link_request_async(link, wtimeout_ms, wbuf, wsz, rbuf, rsz);
+    if (tag < 0)
+        return -1;
+    return shmem_link_wait(link, tag, rtimeout_ms, NULL);
+}
+
+void *shmem_link_tx_alloc(struct link *link, size_t sz)
+{
+    struct shmem_link *slink = link->priv;
+    uint32_t pos;
+    bool ok;
+
+    if (sz > slink->slot_size)
+        return NULL;
+    spin_lock(&slink->lock);
+    ok = tx_reserve_locked(slink, &pos);
+    spin_unlock(&slink->lock);
+    return ok ? req_slot(slink, pos) : NULL;
+}
+
+void shmem_link_tx_free(struct link *link, void *buf)
+{
+    struct shmem_link *slink = link->priv;
+    int slot;
+    bool publish;
+
+    slot = tx_slot_of(slink, buf);
+    assert(slot >= 0);
+    // hand the slot over as an empty message, to keep the ring moving
+    spin_lock(&slink->lock);
+    publish = tx_commit_locked(slink, tx_alloc_pos_locked(slink, slot), 0, 0);
+    spin_unlock(&slink->lock);
+    // requests held back by the slot may have been published
+    if (publish)
+        ring_doorbell(link, CMD_TIMEOUT_MS_SEND);
+}
+
+struct link *shmem_link_connect(const char *name, struct link *doorbell,
+                                void *base, size_t size)
+{
+    struct shmem_link *slink;
+    struct link *link;
+    size_t slot_size;
+
+    INFO("shmem_link_connect: %s: %p size 0x%lx\r\n", name, base, size);
+    assert(((uintptr_t)base % SHMEM_ALIGN) == 0);
+
+    if (size < sizeof(struct shmem_hdr))
+        return NULL;
+    slot_size = (size - sizeof(struct shmem_hdr)) / (2 * SHMEM_SLOTS);
+    slot_size &= ~(size_t)(SHMEM_ALIGN - 1);
+    if (!slot_size) {
+        WARN("%s: %s: shared region too small\r\n", __func__, name);
+        return NULL;
+    }
+
+    link = OBJECT_ALLOC(links);
+    if (!link)
+        return NULL;
+    slink = OBJECT_ALLOC(slinks);
+    if (!slink) {
+        OBJECT_FREE(links, link);
+        return NULL;
+    }
+
+    slink->doorbell = doorbell;
+    slink->hdr = base;
+    slink->slot_size = slot_size;
+    slink->req_data = (uint8_t *)base + sizeof(struct shmem_hdr);
+    slink->rep_data = slink->req_data + SHMEM_SLOTS * slot_size;
+
+    // publish the geometry last: the remote waits for the magic
+    memset(slink->hdr, 0, sizeof(struct shmem_hdr));
+    slink->hdr->version = SHMEM_VERSION;
+    slink->hdr->slots = SHMEM_SLOTS;
+    slink->hdr->slot_size = slot_size;
+    dmbst();
+    slink->hdr->magic = SHMEM_MAGIC;
+    dsbsy();
+
+    link->priv = slink;
+    link->name = name;
+    link->disconnect = shmem_link_disconnect;
+    link->send = shmem_link_send;
+    link->is_send_acked = shmem_link_is_send_acked;
+    link->request = shmem_link_request;
+    link->request_async = shmem_link_request_async;
+    link->wait = shmem_link_wait;
+    link->recv = NULL;
+    return link;
+}
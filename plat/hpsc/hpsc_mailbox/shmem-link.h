@@ -0,0 +1,26 @@
+#ifndef SHMEM_LINK_H
+#define SHMEM_LINK_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "link.h"
+
+// A link for bulk transfers: payloads travel through descriptor rings in a
+// shared memory region and the mailbox link 'doorbell' only notifies the
+// remote that the request ring has new entries. The region must be mapped
+// non-cacheable; its layout is initialized here (see shmem-link.c), so the
+// remote must wait for the header magic before using it.
+struct link *shmem_link_connect(const char *name, struct link *doorbell,
+                                void *base, size_t size);
+
+// Reserve the payload buffer of the next request slot, to fill in place
+// and then pass as 'buf'/'wbuf' to send/request/request_async (which then
+// don't copy the payload). Returns NULL if sz does not fit in a slot or if
+// the ring is full. A buffer that is not sent, e.g. because send/request
+// rejected a size larger than the slot, must be given back with
+// shmem_link_tx_free, or the request ring stalls at its slot.
+void *shmem_link_tx_alloc(struct link *link, size_t sz);
+void shmem_link_tx_free(struct link *link, void *buf);
+
+#endif // SHMEM_LINK_H
@@ -1,77 +1,62 @@
-#define DEBUG 0
-
-#include <stdio.h>
+#include <stdint.h>
+#include <arch.h>
+#include <arch_helpers.h>
+#include <platform.h>
 
 #include "sleep.h"
 
-#define MAX_TIME ~0
-
-static volatile unsigned busyloop_factor = 0;
-
-#if CONFIG_SLEEP_TIMER
-static volatile unsigned time = 0; // cycles @ clk Hz
-static volatile unsigned clk = 0;
-#endif // CONFIG_SLEEP_TIMER
+// While waiting for an event, the counter event stream wakes WFE each time
+// this bit of CNTPCT flips from 0 to 1, i.e. every 2^(bit + 1) ticks (16us at
+// 125 MHz). Interrupts are not taken in EL3, so without it a lost event would
+// stall a waiter until the next unrelated event.
+#define EVENT_STREAM_BIT 10
 
-void sleep_set_busyloop_factor(unsigned f)
+static uint64_t ms_to_ticks(unsigned ms)
 {
-    VERBOSE("SLEEP: busyloop factor <- %u\r\n", f);
-    busyloop_factor = f;
+    return (uint64_t)ms * (plat_get_syscnt_freq2() / 1000);
 }
 
-#if CONFIG_SLEEP_TIMER
-void sleep_set_clock(unsigned f)
+void deadline_init(struct deadline *d, int timeout_ms)
 {
-    VERBOSE("SLEEP: clock <- %u Hz\r\n", f);
-    clk = f;
+    d->start = read_cntpct_el0();
+    if (timeout_ms < 0)
+        d->expiry = UINT64_MAX;
+    else
+        d->expiry = d->start + ms_to_ticks(timeout_ms);
 }
 
-// Call this from a timer ISR
-void sleep_tick(unsigned delta_cycles)
+bool deadline_expired(const struct deadline *d)
 {
-    time += delta_cycles;
-    DPRINTF("SLEEP: time += %u -> %u\r\n", delta_cycles, time);
+    return read_cntpct_el0() >= d->expiry;
 }
-void msleep(unsigned ms)
+
+unsigned deadline_elapsed_ms(const struct deadline *d)
 {
-    ASSERT(clk && "sleep clk not set");
+    return (read_cntpct_el0() - d->start) / (plat_get_syscnt_freq2() / 1000);
+}
 
-    unsigned c = ms * (clk / 1000); // msec to cycles
+void deadline_wait_event(const struct deadline *d)
+{
+    u_register_t cnthctl;
 
-    unsigned wakeup = time + c; // % MAX_TIME implicitly
-    DPRINTF("time %u, wakeup %u\r\n", time, wakeup);
-    int remaining = wakeup >= time ? wakeup - time : (MAX_TIME - time) + wakeup;
-    unsigned last_tick = time;
-    while (remaining > 0) {
-	DPRINTF("SLEEP: sleeping for %u cycles...\r\n", remaining);
-        asm("wfi"); // TODO: change to WFE and add SEV to sleep_tick
+    if (deadline_expired(d))
+        return;
 
-	unsigned elapsed = time >= last_tick ? time - last_tick : (MAX_TIME - last_tick) + time;
-        last_tick = time;
-        remaining -= elapsed;
-    }
-    DPRINTF("SLEEP: awake\r\n");
+    // The event stream belongs to the normal world: borrow it for the wait
+    cnthctl = read_cnthctl_el2();
+    write_cnthctl_el2((cnthctl & ~(EVNTDIR_BIT | (EVNTI_MASK << EVNTI_SHIFT))) |
+                      EVNTEN_BIT | (EVENT_STREAM_BIT << EVNTI_SHIFT));
+    isb();
+    wfe();
+    write_cnthctl_el2(cnthctl);
+    isb();
 }
-#endif // CONFIG_SLEEP_TIMER
 
-void mdelay(unsigned ms)
+void msleep(unsigned ms)
 {
-    // WARNING: don't add any VERBOSE statements into this functions, they
-    // interfere with the timing, despite being outside of the busyloop itself.
-    unsigned iters = ms * busyloop_factor;
-
-    if (iters == 0)
-        return;
+    struct deadline d;
 
-    // Inline assembly, to avoid non-determinism (or total brakage) by
-    // compiler optimizations. This asm is portable across armv7 and
-    // aarch32, but won't necessary take the same time, so each CPU will
-    // need its own calibration factor anyway (see above).
-    asm (
-     "delayloop:\n"
-     "  nop\n"
-     "  sub %0, %0, #1\n"
-     "  cmp %0, #0\n"
-     "  bne delayloop\n"
-     : : "r" (iters) :);
+    deadline_init(&d, ms);
+    while (!deadline_expired(&d))
+        deadline_wait_event(&d);
 }
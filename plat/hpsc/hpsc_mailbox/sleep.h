@@ -1,17 +1,25 @@
 #ifndef SLEEP_H
 #define SLEEP_H
 
-void mdelay(unsigned ms); // busyloop
-void sleep_set_busyloop_factor(unsigned f);
+#include <stdbool.h>
+#include <stdint.h>
 
-#if CONFIG_SLEEP_TIMER
-void sleep_set_clock(unsigned t);
-void msleep(unsigned ms);
+// Deadlines are absolute values of the system counter (CNTPCT), so a wait
+// that is split across several loop iterations does not accumulate drift.
+struct deadline {
+    uint64_t start;
+    uint64_t expiry;
+};
+
+// A negative timeout never expires
+void deadline_init(struct deadline *d, int timeout_ms);
+bool deadline_expired(const struct deadline *d);
+unsigned deadline_elapsed_ms(const struct deadline *d);
 
-// Call this from a timer ISR
-void sleep_tick(unsigned delta);
-#else // !CONFIG_SLEEP_TIMER
-#define msleep(t) mdelay(t)
-#endif // !CONFIG_SLEEP_TIMER
+// Wait for an event (WFE, e.g. an SEV from a mailbox ISR on another core),
+// but return no later than shortly after the deadline.
+void deadline_wait_event(const struct deadline *d);
+
+void msleep(unsigned ms);
 
 #endif // SLEEP_H
@@ -0,0 +1,139 @@
+/*
+ * Copyright (c) 2016-2018, ARM Limited and Contributors. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <debug.h>
+#include <hpsc_sip_svc.h>
+#include <intr_trace.h>
+#include <lock_stat.h>
+#include <pmf.h>
+#include <psci_cpu_on_batch.h>
+#include <psci_stat_hist.h>
+#include <runtime_svc.h>
+#include <stdint.h>
+#include <uuid.h>
+
+
+/* HPSC SiP Service UUID */
+DEFINE_SVC_UUID2(hpsc_sip_svc_uid,
+	0x3b1c6f2e, 0x9a41, 0x4c57, 0x8d, 0x02,
+	0x5e, 0x71, 0xa4, 0x0b, 0xc3, 0x96);
+
+static int hpsc_sip_setup(void)
+{
+#if ENABLE_PMF
+	if (pmf_setup() != 0)
+		return 1;
+#endif
+	return 0;
+}
+
+/*
+ * This function handles HPSC defined SiP Calls
+ */
+static uintptr_t hpsc_sip_handler(unsigned int smc_fid,
+			u_register_t x1,
+			u_register_t x2,
+			u_register_t x3,
+			u_register_t x4,
+			void *cookie,
+			void *handle,
+			u_register_t flags)
+{
+	int call_count = 0;
+
+#if ENABLE_PMF
+	/*
+	 * Dispatch PMF calls (e.g. the time-stamps of the TRCH requests
+	 * recorded by pm_ipi) to PMF SMC handler and return its return value
+	 */
+	if (is_pmf_fid(smc_fid)) {
+		return pmf_smc_handler(smc_fid, x1, x2, x3, x4, cookie,
+				handle, flags);
+	}
+#endif
+
+#if ENABLE_LOCK_STATS
+	/* Dispatch lock statistics calls to their SMC handler */
+	if (is_lock_stat_fid(smc_fid)) {
+		return lock_stat_smc_handler(smc_fid, x1, x2, x3, x4, cookie,
+				handle, flags);
+	}
+#endif
+
+#if ENABLE_INTR_TRACE
+	/* Dispatch EL3 interrupt trace calls to their SMC handler */
+	if (is_intr_trace_fid(smc_fid)) {
+		return intr_trace_smc_handler(smc_fid, x1, x2, x3, x4, cookie,
+				handle, flags);
+	}
+#endif
+
+#if PSCI_STAT_HIST
+	/* Dispatch PSCI statistics histograms calls to their SMC handler */
+	if (is_psci_stat_hist_fid(smc_fid)) {
+		return psci_stat_hist_smc_handler(smc_fid, x1, x2, x3, x4,
+				cookie, handle, flags);
+	}
+#endif
+
+#if PSCI_CPU_ON_BATCH
+	/* Dispatch batch CPU_ON calls to their SMC handler */
+	if (is_psci_cpu_on_batch_fid(smc_fid)) {
+		return psci_cpu_on_batch_smc_handler(smc_fid, x1, x2, x3, x4,
+				cookie, handle, flags);
+	}
+#endif
+
+	switch (smc_fid) {
+	case HPSC_SIP_SVC_CALL_COUNT:
+#if ENABLE_PMF
+		/* PMF calls */
+		call_count += PMF_NUM_SMC_CALLS;
+#endif
+#if ENABLE_LOCK_STATS
+		/* Lock statistics calls */
+		call_count += LOCK_STAT_NUM_SMC_CALLS;
+#endif
+#if ENABLE_INTR_TRACE
+		/* EL3 interrupt trace calls */
+		call_count += INTR_TRACE_NUM_SMC_CALLS;
+#endif
+#if PSCI_STAT_HIST
+		/* PSCI statistics histograms calls */
+		call_count += PSCI_STAT_HIST_NUM_SMC_CALLS;
+#endif
+#if PSCI_CPU_ON_BATCH
+		/* Batch CPU_ON calls */
+		call_count += PSCI_CPU_ON_BATCH_NUM_SMC_CALLS;
+#endif
+
+		SMC_RET1(handle, call_count);
+
+	case HPSC_SIP_SVC_UID:
+		/* Return UID to the caller */
+		SMC_UUID_RET(handle, hpsc_sip_svc_uid);
+
+	case HPSC_SIP_SVC_VERSION:
+		/* Return the version of current implementation */
+		SMC_RET2(handle, HPSC_SIP_SVC_VERSION_MAJOR, HPSC_SIP_SVC_VERSION_MINOR);
+
+	default:
+		WARN("Unimplemented HPSC SiP Service Call: 0x%x \n", smc_fid);
+		SMC_RET1(handle, SMC_UNK);
+	}
+
+}
+
+
+/* Define a runtime service descriptor for fast SMC calls */
+DECLARE_RT_SVC(
+	hpsc_sip_svc,
+	OEN_SIP_START,
+	OEN_SIP_END,
+	SMC_TYPE_FAST,
+	hpsc_sip_setup,
+	hpsc_sip_handler
+);
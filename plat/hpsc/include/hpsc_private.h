@@ -0,0 +1,19 @@
+/*
+ * Copyright (c) 2018, ARM Limited and Contributors. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef HPSC_PRIVATE_H
+#define HPSC_PRIVATE_H
+
+#include <interrupt_mgmt.h>
+#include <stdint.h>
+
+/*
+ * Interrupts taken in EL3 (Group 0) are dispatched by INTID to the handlers
+ * registered here. A handler acknowledges and ends the interrupt itself.
+ */
+int request_intr_type_el3(uint32_t id, interrupt_type_handler_t handler);
+
+#endif /* HPSC_PRIVATE_H */
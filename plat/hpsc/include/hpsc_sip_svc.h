@@ -0,0 +1,21 @@
+/*
+ * Copyright (c) 2016-2018, ARM Limited and Contributors. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef HPSC_SIP_SVC_H
+#define HPSC_SIP_SVC_H
+
+/* SMC function IDs for SiP Service queries */
+
+#define HPSC_SIP_SVC_CALL_COUNT		0x8200ff00
+#define HPSC_SIP_SVC_UID		0x8200ff01
+/*					0x8200ff02 is reserved */
+#define HPSC_SIP_SVC_VERSION		0x8200ff03
+
+/* HPSC SiP Service Calls version numbers */
+#define HPSC_SIP_SVC_VERSION_MAJOR	0x0
+#define HPSC_SIP_SVC_VERSION_MINOR	0x1
+
+#endif /* HPSC_SIP_SVC_H */
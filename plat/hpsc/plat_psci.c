@@ -15,6 +15,7 @@
 #include <plat_arm.h>
 #include <platform.h>
 #include <psci.h>
+#include <spinlock.h>
 #include "pm_ipi.h"
 #include "hpsc_def.h"
 #include "include/platform_def.h"
@@ -75,9 +76,14 @@ enum pm_api_id {
 	PM_REQ_WAKEUP,
 	PM_SET_WAKEUP_SOURCE,
 	PM_SYSTEM_SHUTDOWN,
+	/* One request (wakeup/self-suspend) for a set of cores */
+	PM_BATCH,
 	PM_API_MAX
 };
 
+/* every API id gets its slots in the PMF latency service of pm_ipi */
+CASSERT(PM_API_MAX <= PM_IPI_TS_APIS, assert_pm_ipi_ts_apis);
+
 enum pm_request_ack {
 	REQ_ACK_NO = 1,
 	REQ_ACK_BLOCKING,
@@ -126,24 +132,23 @@ static unsigned int pm_get_shutdown_scope()
 }
 
 /**
- * pm_self_suspend() - PM call for processor to suspend itself
- * @nid		Node id of the processor or subsystem
+ * pm_self_suspend_cpu() - PM call for a processor to suspend itself
+ * @cpuid	Linear index of the processor
  * @latency	Requested maximum wakeup latency (not supported)
  * @state	Requested state
  * @address	Resume address
  *
- * This is a blocking call, it will return only once PMU has responded.
- * On a wakeup, resume address will be automatically set by PMU.
+ * Same as pm_self_suspend(), but the request may be sent on behalf of the
+ * processor by another core (see pm_batch_submit()).
  *
  * @return	Returns status, either success or error+reason
  */
-static enum pm_ret_status pm_self_suspend(enum pm_node_id nid,
+static enum pm_ret_status pm_self_suspend_cpu(unsigned int cpuid,
 				   unsigned int latency,
 				   unsigned int state,
 				   uintptr_t address)
 {
 	uint32_t payload[PAYLOAD_ARG_CNT];
-	unsigned int cpuid = plat_my_core_pos();
 	const struct pm_proc *proc = pm_get_proc(cpuid);
 
 	/* Send request to the PMU */
@@ -152,6 +157,160 @@ static enum pm_ret_status pm_self_suspend(enum pm_node_id nid,
 	return pm_ipi_send_sync(proc, payload, NULL, 0);
 }
 
+#if HPSC_PM_BATCH
+/*
+ * Requests of one kind from several cores are coalesced into one PM_BATCH
+ * message. While a core (the combiner) has a request in flight, requests
+ * from other cores collect in the pending set; the next core to find the
+ * channel idle sends all of them at once and completes them on behalf of
+ * their owners, which wait in WFE. A lone request goes out as a regular
+ * message. Only requests with the same arguments are coalesced.
+ *
+ * PM_BATCH payload: api id, bitmap of cores, address (2 words), argument.
+ * The reply holds one pm_ret_status per core, in bitmap bit order.
+ */
+struct pm_batch {
+	spinlock_t lock;
+	const unsigned int api_id;
+	bool sending;
+	uint32_t pending;	/* cores whose request is not sent yet */
+	uint32_t done;		/* cores whose request is complete */
+	uint64_t address;
+	unsigned int arg;
+	enum pm_ret_status status[PLATFORM_CORE_COUNT];
+};
+
+static struct pm_batch pm_wakeup_batch = { .api_id = PM_REQ_WAKEUP };
+static struct pm_batch pm_suspend_batch = { .api_id = PM_SELF_SUSPEND };
+
+static enum pm_ret_status pm_batch_send_one(struct pm_batch *b,
+					    unsigned int cpuid,
+					    uint64_t address, unsigned int arg)
+{
+	uint32_t payload[PAYLOAD_ARG_CNT];
+
+	if (b->api_id == PM_SELF_SUSPEND)
+		return pm_self_suspend_cpu(cpuid, MAX_LATENCY, arg, address);
+
+	PM_PACK_PAYLOAD5(payload, PM_REQ_WAKEUP, pm_get_proc(cpuid)->node_id,
+			 address, address >> 32, arg);
+	return pm_ipi_send_sync(primary_proc, payload, NULL, 0);
+}
+
+static void pm_batch_send(struct pm_batch *b, uint32_t cpus,
+			  uint64_t address, unsigned int arg,
+			  enum pm_ret_status *status)
+{
+	uint32_t payload[PAYLOAD_ARG_CNT];
+	unsigned int value[PLATFORM_CORE_COUNT];
+	enum pm_ret_status ret;
+	unsigned int i;
+
+	if (!(cpus & (cpus - 1))) {
+		i = __builtin_ctz(cpus);
+		status[i] = pm_batch_send_one(b, i, address, arg);
+		return;
+	}
+
+	VERBOSE("%s: api %u cpus 0x%x\n", __func__, b->api_id, cpus);
+	PM_PACK_PAYLOAD6(payload, PM_BATCH, b->api_id, cpus, address,
+			 address >> 32, arg);
+	ret = pm_ipi_send_sync(primary_proc, payload, value,
+			       PLATFORM_CORE_COUNT);
+	for (i = 0; i < PLATFORM_CORE_COUNT; i++)
+		if (cpus & (1U << i))
+			status[i] = ret != PM_RET_SUCCESS ? ret : value[i];
+}
+
+/*
+ * Submit the requests of the cores in `mask`, on their behalf or for their
+ * own, and wait for their completion. The status of each request is returned
+ * in `status`, indexed by core.
+ */
+static void pm_batch_submit_cpus(struct pm_batch *b, uint32_t mask,
+				 uint64_t address, unsigned int arg,
+				 enum pm_ret_status *status)
+{
+	uint32_t cpus;
+	unsigned int i;
+
+	spin_lock(&b->lock);
+	if (b->pending && (b->address != address || b->arg != arg)) {
+		/* can't join the pending batch: send on our own */
+		spin_unlock(&b->lock);
+		pm_batch_send(b, mask, address, arg, status);
+		return;
+	}
+	b->pending |= mask;
+	b->address = address;
+	b->arg = arg;
+
+	while ((b->done & mask) != mask) {
+		if (b->sending || !(b->pending & mask)) {
+			/* our requests are queued or in flight with another core */
+			spin_unlock(&b->lock);
+			wfe();
+			spin_lock(&b->lock);
+			continue;
+		}
+
+		cpus = b->pending;
+		b->pending = 0;
+		b->sending = true;
+		spin_unlock(&b->lock);
+
+		pm_batch_send(b, cpus, address, arg, b->status);
+
+		spin_lock(&b->lock);
+		b->sending = false;
+		b->done |= cpus;
+		dsbish();
+		sev();
+	}
+
+	b->done &= ~mask;
+	for (i = 0; i < PLATFORM_CORE_COUNT; i++)
+		if (mask & (1U << i))
+			status[i] = b->status[i];
+	spin_unlock(&b->lock);
+}
+
+static enum pm_ret_status pm_batch_submit(struct pm_batch *b,
+					  unsigned int cpuid,
+					  uint64_t address, unsigned int arg)
+{
+	enum pm_ret_status status[PLATFORM_CORE_COUNT];
+
+	pm_batch_submit_cpus(b, 1U << cpuid, address, arg, status);
+	return status[cpuid];
+}
+#endif /* HPSC_PM_BATCH */
+
+/**
+ * pm_self_suspend() - PM call for processor to suspend itself
+ * @nid		Node id of the processor or subsystem
+ * @latency	Requested maximum wakeup latency (not supported)
+ * @state	Requested state
+ * @address	Resume address
+ *
+ * This is a blocking call, it will return only once PMU has responded.
+ * On a wakeup, resume address will be automatically set by PMU.
+ *
+ * @return	Returns status, either success or error+reason
+ */
+static enum pm_ret_status pm_self_suspend(enum pm_node_id nid,
+				   unsigned int latency,
+				   unsigned int state,
+				   uintptr_t address)
+{
+#if HPSC_PM_BATCH
+	return pm_batch_submit(&pm_suspend_batch, plat_my_core_pos(), address,
+			       state);
+#else
+	return pm_self_suspend_cpu(plat_my_core_pos(), latency, state, address);
+#endif
+}
+
 #if 0 /* unused, but keeping for symmetry with wakeup */
 /**
  * pm_req_suspend() - PM call to request for another PU or subsystem to
@@ -249,22 +408,73 @@ static void hpsc_cpu_standby(plat_local_state_t cpu_state)
 static int hpsc_pwr_domain_on(u_register_t mpidr)
 {
 	unsigned int cpu_id = plat_core_pos_by_mpidr(mpidr);
-	const struct pm_proc *proc;
 	VERBOSE("%s: cpu_id(0x%x):  mpidr: 0x%lx\n", __func__, cpu_id, mpidr);
 	if (cpu_id >= 0x100) cpu_id = cpu_id - 0x100 + 4;
 
 	if (cpu_id == -1)
 		return PSCI_E_INTERN_FAIL;
 
-	proc = pm_get_proc(cpu_id);
 	/* Clear power down request */
 
 	/* Send request to TRCH to wake up selected APU CPU core */
-	pm_req_wakeup(proc->node_id, 1, hpsc_sec_entry, REQ_ACK_BLOCKING);
+#if HPSC_PM_BATCH
+	pm_batch_submit(&pm_wakeup_batch, cpu_id, hpsc_sec_entry | 1,
+			REQ_ACK_BLOCKING);
+#else
+	pm_req_wakeup(pm_get_proc(cpu_id)->node_id, 1, hpsc_sec_entry,
+		      REQ_ACK_BLOCKING);
+#endif
 
 	return PSCI_E_SUCCESS;
 }
 
+#if PSCI_CPU_ON_BATCH
+static int hpsc_pwr_domain_on_batch(const u_register_t *mpidrs,
+				    unsigned int count, unsigned int *on_mask)
+{
+	enum pm_ret_status status[PLATFORM_CORE_COUNT];
+	int cpu_ids[PLATFORM_CORE_COUNT];
+	uint32_t cpus = 0;
+	unsigned int i;
+	int ret = PSCI_E_SUCCESS;
+
+	assert(count <= PLATFORM_CORE_COUNT);
+
+	for (i = 0; i < count; i++) {
+		cpu_ids[i] = plat_core_pos_by_mpidr(mpidrs[i]);
+		if (cpu_ids[i] < 0)
+			return PSCI_E_INTERN_FAIL;
+		cpus |= 1U << cpu_ids[i];
+	}
+	VERBOSE("%s: cpus: 0x%x\n", __func__, cpus);
+
+	/* Send one request to TRCH to wake up all the selected APU CPU cores */
+#if HPSC_PM_BATCH
+	pm_batch_submit_cpus(&pm_wakeup_batch, cpus, hpsc_sec_entry | 1,
+			     REQ_ACK_BLOCKING, status);
+#else
+	for (i = 0; i < count; i++)
+		status[cpu_ids[i]] = pm_req_wakeup(
+				pm_get_proc(cpu_ids[i])->node_id, 1,
+				hpsc_sec_entry, REQ_ACK_BLOCKING);
+#endif
+
+	/* Report the cores TRCH failed to wake up for the PSCI layer to revert */
+	for (i = 0; i < count; i++) {
+		if (status[cpu_ids[i]] == PM_RET_SUCCESS) {
+			*on_mask |= 1U << i;
+			continue;
+		}
+
+		ERROR("%s: failed to wake up cpu %d (%d)\n", __func__,
+		      cpu_ids[i], status[cpu_ids[i]]);
+		ret = PSCI_E_INTERN_FAIL;
+	}
+
+	return ret;
+}
+#endif /* PSCI_CPU_ON_BATCH */
+
 static void hpsc_pwr_domain_off(const psci_power_state_t *target_state)
 {
 	unsigned int cpu_id = plat_my_core_pos();
@@ -335,10 +545,11 @@ static void hpsc_pwr_domain_suspend_finish(const psci_power_state_t *target_stat
 #endif // PLAT_HAS_INTERCONNECT
 	/* APU was turned off */
 	if (target_state->pwr_domain_state[1] > PLAT_MAX_RET_STATE) {	/* > 1 */
-		WARN("%s: cpu(%d): plat_arm_gic_init()\n", __func__, cpu_id);
+		VERBOSE("%s: cpu(%d): plat_arm_gic_init()\n", __func__, cpu_id);
 		plat_arm_gic_init();
+		pm_ipi_route_irqs();
 	} else {
-		WARN("%s: cpu(%d): gicv3_cpuif_enable()\n", __func__, cpu_id);
+		VERBOSE("%s: cpu(%d): gicv3_cpuif_enable()\n", __func__, cpu_id);
 		gicv3_cpuif_enable(plat_my_core_pos());
 		gicv3_rdistif_init(plat_my_core_pos());
 	}
@@ -420,6 +631,9 @@ static void hpsc_get_sys_suspend_power_state(psci_power_state_t *req_state)
 static const struct plat_psci_ops hpsc_psci_ops = {
 	.cpu_standby			= hpsc_cpu_standby,
 	.pwr_domain_on			= hpsc_pwr_domain_on,
+#if PSCI_CPU_ON_BATCH
+	.pwr_domain_on_batch		= hpsc_pwr_domain_on_batch,
+#endif
 	.pwr_domain_off			= hpsc_pwr_domain_off,
 	.pwr_domain_suspend		= hpsc_pwr_domain_suspend,
 	.pwr_domain_on_finish		= hpsc_pwr_domain_on_finish,
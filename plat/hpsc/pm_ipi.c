@@ -5,15 +5,17 @@
  */
 
 #include <arch_helpers.h>
-#include <bakery_lock.h>
 #include <platform.h>
-#include <arch_helpers.h>
 #include <debug.h>
+#include <pmf.h>
+#include <utils_def.h>
 #include "pm_ipi.h"
 
 #if TRCH_SERVER
 #include <gicv3.h>
+#include <interrupt_mgmt.h>
 #include "gic.h"
+#include "hpsc_private.h"
 #include "hwinfo.h"
 #include "mailbox.h"
 #include "mailbox-link.h"
@@ -25,12 +27,142 @@
 #define IPI_BLOCKING		1
 #define IPI_NON_BLOCKING	0
 
-DEFINE_BAKERY_LOCK(pm_secure_lock);
-
 #if TRCH_SERVER
-struct link *trch_atf_link;
+/*
+ * With HPSC_MBOX_PER_CORE, each core talks to TRCH over its own mailbox pair,
+ * so that requests from different cores do not contend for a link. Otherwise,
+ * or if its link could not be set up, a core uses the link of CPU0 (links
+ * serialize their users).
+ */
+struct trch_atf_link_desc {
+	const char *name;
+	unsigned int idx_from;
+	unsigned int idx_to;
+	unsigned int client;
+};
+
+static const struct trch_atf_link_desc trch_atf_link_descs[] = {
+	{ "TRCH_MBOX_ATF_LINK", MBOX_HPPS_TRCH__TRCH_ATF_HPPS,
+	  MBOX_HPPS_TRCH__HPPS_ATF_TRCH, MASTER_ID_HPPS_CPU0 },
+	{ "TRCH_MBOX_ATF_LINK_CPU1", MBOX_HPPS_TRCH__TRCH_ATF_HPPS_CPU1,
+	  MBOX_HPPS_TRCH__HPPS_ATF_TRCH_CPU1, MASTER_ID_HPPS_CPU1 },
+	{ "TRCH_MBOX_ATF_LINK_CPU2", MBOX_HPPS_TRCH__TRCH_ATF_HPPS_CPU2,
+	  MBOX_HPPS_TRCH__HPPS_ATF_TRCH_CPU2, MASTER_ID_HPPS_CPU2 },
+	{ "TRCH_MBOX_ATF_LINK_CPU3", MBOX_HPPS_TRCH__TRCH_ATF_HPPS_CPU3,
+	  MBOX_HPPS_TRCH__HPPS_ATF_TRCH_CPU3, MASTER_ID_HPPS_CPU3 },
+	{ "TRCH_MBOX_ATF_LINK_CPU4", MBOX_HPPS_TRCH__TRCH_ATF_HPPS_CPU4,
+	  MBOX_HPPS_TRCH__HPPS_ATF_TRCH_CPU4, MASTER_ID_HPPS_CPU4 },
+	{ "TRCH_MBOX_ATF_LINK_CPU5", MBOX_HPPS_TRCH__TRCH_ATF_HPPS_CPU5,
+	  MBOX_HPPS_TRCH__HPPS_ATF_TRCH_CPU5, MASTER_ID_HPPS_CPU5 },
+	{ "TRCH_MBOX_ATF_LINK_CPU6", MBOX_HPPS_TRCH__TRCH_ATF_HPPS_CPU6,
+	  MBOX_HPPS_TRCH__HPPS_ATF_TRCH_CPU6, MASTER_ID_HPPS_CPU6 },
+	{ "TRCH_MBOX_ATF_LINK_CPU7", MBOX_HPPS_TRCH__TRCH_ATF_HPPS_CPU7,
+	  MBOX_HPPS_TRCH__HPPS_ATF_TRCH_CPU7, MASTER_ID_HPPS_CPU7 },
+};
+
+CASSERT(ARRAY_SIZE(trch_atf_link_descs) >= PLATFORM_CORE_COUNT,
+	assert_trch_atf_link_per_core);
+
+static struct link *trch_atf_links[PLATFORM_CORE_COUNT];
 #endif
 
+#if TRCH_SERVER && HPSC_MBOX_IRQ
+/**
+ * pm_ipi_mbox_intr_handler() - Handle the mailbox interrupts of the links
+ * @id		INTID of the pending interrupt
+ *
+ * Called in EL3 on the core that took the interrupt, usually one that was
+ * running in the normal world: the mailbox ISR completes the request and
+ * wakes up the core that waits for it.
+ *
+ * @return	0
+ */
+static uint64_t pm_ipi_mbox_intr_handler(uint32_t id, uint32_t flags,
+					 void *handle, void *cookie)
+{
+	uint32_t intr = plat_ic_acknowledge_interrupt();
+
+	if (intr >= MAX_INTR_EL3)
+		return 0;	/* spurious, e.g. taken by another core */
+
+	if (intr == HPPS_RCV_INTID)
+		mbox_rcv_isr(HPPS_RCV_IRQ_IDX);
+	else if (intr == HPPS_ACK_INTID)
+		mbox_ack_isr(HPPS_ACK_IRQ_IDX);
+	else
+		WARN("%s: unexpected interrupt %u\n", __func__, intr);
+
+	plat_ic_end_of_interrupt(intr);
+	return 0;
+}
+
+/**
+ * pm_ipi_mbox_irq_poll() - Service the mailbox interrupts routed to this core
+ *
+ * A core that waits for TRCH in EL3 cannot take interrupts; an interrupt that
+ * the GIC routed to it would wait until it returns to the normal world, so
+ * the waiter handles it instead. Reading the pending INTID costs a system
+ * register access, rather than the mailbox registers of all links.
+ */
+static void pm_ipi_mbox_irq_poll(void)
+{
+	uint32_t id = plat_ic_get_pending_interrupt_id();
+
+	if (id == HPPS_RCV_INTID || id == HPPS_ACK_INTID)
+		pm_ipi_mbox_intr_handler(id, 0, NULL, NULL);
+}
+
+/**
+ * pm_ipi_route_irqs() - Let any core take the mailbox interrupts
+ *
+ * The GIC driver routes secure SPIs to the core that initializes the
+ * distributor, so this is repeated whenever it does.
+ */
+void pm_ipi_route_irqs(void)
+{
+	plat_ic_set_spi_routing(HPPS_RCV_INTID, INTR_ROUTING_MODE_ANY, 0);
+	plat_ic_set_spi_routing(HPPS_ACK_INTID, INTR_ROUTING_MODE_ANY, 0);
+}
+#else
+void pm_ipi_route_irqs(void)
+{
+}
+#endif /* TRCH_SERVER && HPSC_MBOX_IRQ */
+
+#if TRCH_SERVER && ENABLE_PMF
+PMF_REGISTER_SERVICE_SMC(pm_ipi_svc, PMF_HPSC_PM_IPI_SVC_ID,
+			 PM_IPI_TS_TOTAL_IDS, PMF_STORE_ENABLE)
+
+/**
+ * pm_ipi_capture_times() - Record the progress of a request to TRCH
+ * @api_id	API id of the request
+ * @enter	Time-stamp of when the request was issued
+ * @times	Time-stamps reported by the link
+ *
+ * All points are written once the request is complete, so a reader sees
+ * them (mostly) from the same request.
+ */
+static void pm_ipi_capture_times(uint32_t api_id, unsigned long long enter,
+				 const struct link_req_times *times)
+{
+	unsigned long long ts;
+
+	if (api_id >= PM_IPI_TS_APIS)
+		return;
+
+	PMF_WRITE_TIMESTAMP(pm_ipi_svc, PM_IPI_TS_ID(api_id, PM_IPI_TS_ENTER),
+			    PMF_NO_CACHE_MAINT, enter);
+	ts = times->sent;
+	PMF_WRITE_TIMESTAMP(pm_ipi_svc, PM_IPI_TS_ID(api_id, PM_IPI_TS_SENT),
+			    PMF_NO_CACHE_MAINT, ts);
+	ts = times->acked;
+	PMF_WRITE_TIMESTAMP(pm_ipi_svc, PM_IPI_TS_ID(api_id, PM_IPI_TS_ACK),
+			    PMF_NO_CACHE_MAINT, ts);
+	PMF_CAPTURE_TIMESTAMP(pm_ipi_svc, PM_IPI_TS_ID(api_id, PM_IPI_TS_DONE),
+			      PMF_NO_CACHE_MAINT);
+}
+#endif /* TRCH_SERVER && ENABLE_PMF */
+
 /**
  * pm_ipi_init() - Initialize IPI peripheral for communication with PMU
  *
@@ -43,8 +175,10 @@ struct link *trch_atf_link;
  */
 int pm_ipi_init(const struct pm_proc *proc)
 {
-	bakery_lock_init(&pm_secure_lock);
 #if TRCH_SERVER
+	const struct trch_atf_link_desc *desc;
+	unsigned int cpu;
+
 	gic_init((volatile uint32_t *)HPPS_GIC_BASE);
 	struct irq *hpps_rcv_irq = 
 		gic_request(HPPS_IRQ__HT_MBOX_0 + HPPS_RCV_IRQ_IDX,
@@ -54,17 +188,45 @@ int pm_ipi_init(const struct pm_proc *proc)
 			GIC_IRQ_TYPE_SPI, GIC_IRQ_CFG_LEVEL);
 
 
-	trch_atf_link = mbox_link_connect("TRCH_MBOX_ATF_LINK",
-			MBOX_HPPS_TRCH__BASE,
-			MBOX_HPPS_TRCH__TRCH_ATF_HPPS, MBOX_HPPS_TRCH__HPPS_ATF_TRCH,
-			hpps_rcv_irq, HPPS_RCV_IRQ_IDX, /* 28 */
-			hpps_ack_irq, HPPS_ACK_IRQ_IDX, /* 29 */
-			0,
-			MASTER_ID_HPPS_CPU0);
-	if (!trch_atf_link)
-	   VERBOSE("%s: panic: TRCH_MBOX_ATF_LINK failed to be created\n", __func__);
-	else 
-   	   VERBOSE("%s: successfully initialized TRCH_MBOX_ATF_LINK \n", __func__);
+	/* All links share the ATF interrupts of the mailbox block */
+	for (cpu = 0; cpu < PLATFORM_CORE_COUNT; cpu++) {
+		if ((cpu != 0) && !HPSC_MBOX_PER_CORE) {
+			trch_atf_links[cpu] = trch_atf_links[0];
+			continue;
+		}
+
+		desc = &trch_atf_link_descs[cpu];
+		trch_atf_links[cpu] = mbox_link_connect(desc->name,
+				MBOX_HPPS_TRCH__BASE,
+				desc->idx_from, desc->idx_to,
+				hpps_rcv_irq, HPPS_RCV_IRQ_IDX,
+				hpps_ack_irq, HPPS_ACK_IRQ_IDX,
+				0,
+				desc->client);
+		if (!trch_atf_links[cpu]) {
+			WARN("%s: %s failed to be created\n", __func__, desc->name);
+			trch_atf_links[cpu] = trch_atf_links[0];
+		} else {
+			VERBOSE("%s: successfully initialized %s\n", __func__,
+				desc->name);
+		}
+	}
+	if (!trch_atf_links[0])
+		ERROR("%s: no link to TRCH\n", __func__);
+
+#if HPSC_MBOX_IRQ
+	if (trch_atf_links[0] &&
+	    !request_intr_type_el3(HPPS_RCV_INTID, pm_ipi_mbox_intr_handler) &&
+	    !request_intr_type_el3(HPPS_ACK_INTID, pm_ipi_mbox_intr_handler)) {
+		pm_ipi_route_irqs();
+		for (cpu = 0; cpu < PLATFORM_CORE_COUNT; cpu++)
+			mbox_link_set_irq_poll(trch_atf_links[cpu],
+					       pm_ipi_mbox_irq_poll);
+	} else {
+		WARN("%s: mailbox interrupts not available, polling\n",
+		     __func__);
+	}
+#endif
 #endif
 
 	return 0;
@@ -75,8 +237,9 @@ int pm_ipi_init(const struct pm_proc *proc)
  * @proc	Pointer to the processor who is initiating request
  * @payload	API id and call arguments to be written in IPI buffer
  *
- * Send an IPI request to the power controller. Caller needs to hold
- * the 'pm_secure_lock' lock.
+ * Send an IPI request to the power controller over the link of the calling
+ * core (which may differ from @proc when a request is sent on behalf of
+ * another core), so requests from different cores proceed in parallel.
  *
  * @return	Returns status, either success or error+reason
  */
@@ -88,10 +251,14 @@ static enum pm_ret_status pm_ipi_send_common(const struct pm_proc *proc,
 {
 #if TRCH_SERVER
 	/* send PSCI command request to TRCH */
-	/* initial test code */
-	uint32_t mbox_payload[32];
+	uint32_t mbox_payload[PAYLOAD_ARG_CNT + 2];
+	struct link *link = trch_atf_links[plat_my_core_pos()];
+	struct link_req_times times = { 0 };
+	int tag, rc;
+#if ENABLE_PMF
+	unsigned long long enter = read_cntpct_el0();
+#endif
 
-	// INFO("pm_ipi_send_common: send mail to TRCH\n");
 	/* The first two words are added
          * 0: CMD_PSCI
          * 1: node_id of the caller */
@@ -101,12 +268,22 @@ static enum pm_ret_status pm_ipi_send_common(const struct pm_proc *proc,
 		mbox_payload[i+2] = payload[i];
 	}
 
-	/* send payload and get ack */
-	int rc = trch_atf_link->request(trch_atf_link, 
-				CMD_TIMEOUT_MS_SEND, mbox_payload, (PAYLOAD_ARG_CNT + 1) * sizeof(uint32_t)/* sizeof(PAYLOAD_ARG_CNT+1) */,
-				CMD_TIMEOUT_MS_RECV, value, count * sizeof(uint32_t));
-	if (rc < 0) 
-		return rc;
+	if (!link)
+		return PM_RET_ERROR_COMMUNIC;
+
+	tag = link->request_async(link,
+				CMD_TIMEOUT_MS_SEND, mbox_payload, sizeof(mbox_payload),
+				value, count * sizeof(uint32_t));
+	if (tag < 0)
+		return PM_RET_ERROR_COMMUNIC;
+
+	/* wait for the ack (and the reply, if any) */
+	rc = link->wait(link, tag, CMD_TIMEOUT_MS_RECV, &times);
+#if ENABLE_PMF
+	pm_ipi_capture_times(payload[0], enter, &times);
+#endif
+	if (rc < 0 || (count && !rc))
+		return PM_RET_ERROR_TIMEOUT;
 #endif
 	return PM_RET_SUCCESS;
 }
@@ -126,9 +303,7 @@ enum pm_ret_status pm_ipi_send_non_blocking(const struct pm_proc *proc,
 {
 	enum pm_ret_status ret;
 
-	bakery_lock_get(&pm_secure_lock);
 	ret = pm_ipi_send_common(proc, payload, IPI_NON_BLOCKING, NULL, 0);
-	bakery_lock_release(&pm_secure_lock);
 
 	return ret;
 }
@@ -148,9 +323,7 @@ enum pm_ret_status pm_ipi_send(const struct pm_proc *proc,
 	enum pm_ret_status ret;
 
 	VERBOSE("pm_ipi_send : start \n");
-	bakery_lock_get(&pm_secure_lock);
 	ret = pm_ipi_send_common(proc, payload, IPI_BLOCKING, NULL, 0);
-	bakery_lock_release(&pm_secure_lock);
 	return ret;
 }
 
@@ -173,9 +346,7 @@ enum pm_ret_status pm_ipi_send_sync(const struct pm_proc *proc,
 	enum pm_ret_status ret;
 	VERBOSE("pm_ipi_send_sync: start \n");
 
-	bakery_lock_get(&pm_secure_lock);
 	ret = pm_ipi_send_common(proc, payload, IPI_BLOCKING, value, count);
-	bakery_lock_release(&pm_secure_lock);
 	return ret;
 }
 
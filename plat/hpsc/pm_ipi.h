@@ -10,6 +10,21 @@
 #define PAYLOAD_ARG_CNT		6U
 #define PAYLOAD_ARG_SIZE	4U	/* size in bytes */
 
+/*
+ * PMF service with the latency of requests to TRCH. For each core, the last
+ * request of each API id leaves one time-stamp per point below; requests
+ * with an API id beyond PM_IPI_TS_APIS are not recorded.
+ */
+#define PMF_HPSC_PM_IPI_SVC_ID	8
+#define PM_IPI_TS_ENTER		0	/* request issued */
+#define PM_IPI_TS_SENT		1	/* link acquired, message written */
+#define PM_IPI_TS_ACK		2	/* TRCH took the message */
+#define PM_IPI_TS_DONE		3	/* reply received (ack if no reply) */
+#define PM_IPI_TS_POINTS	4
+#define PM_IPI_TS_APIS		16
+#define PM_IPI_TS_ID(api, point)	((api) * PM_IPI_TS_POINTS + (point))
+#define PM_IPI_TS_TOTAL_IDS	(PM_IPI_TS_APIS * PM_IPI_TS_POINTS)
+
 enum pm_node_id {
 	NODE_UNKNOWN = 0,
 	NODE_APU,
@@ -68,6 +83,7 @@ enum pm_ret_status {
 
 
 int pm_ipi_init(const struct pm_proc *proc);
+void pm_ipi_route_irqs(void);
 
 enum pm_ret_status pm_ipi_send(const struct pm_proc *proc,
 			       uint32_t payload[PAYLOAD_ARG_CNT]);
@@ -0,0 +1,13 @@
+/*
+ * Host stand-in for the TF-A header, for the simulated mailbox stack.
+ */
+#ifndef ARCH_H
+#define ARCH_H
+
+/* CNTHCTL_EL2 fields used by sleep.c (ignored on the host) */
+#define EVNTEN_BIT	(1U << 2)
+#define EVNTDIR_BIT	(1U << 3)
+#define EVNTI_SHIFT	4
+#define EVNTI_MASK	0xfU
+
+#endif /* ARCH_H */
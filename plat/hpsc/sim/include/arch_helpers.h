@@ -0,0 +1,42 @@
+/*
+ * Host stand-in for the TF-A header, for the simulated mailbox stack.
+ * Barriers map to compiler/CPU fences, WFE to a yield and the system
+ * counter to CLOCK_MONOTONIC, scaled to the frequency of the platform.
+ */
+#ifndef ARCH_HELPERS_H
+#define ARCH_HELPERS_H
+
+#include <sched.h>
+#include <stdint.h>
+#include <time.h>
+
+typedef uint64_t u_register_t;
+
+#define SIM_SYSCNT_FREQ	125000000ULL
+
+static inline uint64_t read_cntpct_el0(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ((uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec) *
+		(SIM_SYSCNT_FREQ / 1000000ULL) / 1000ULL;
+}
+
+static inline u_register_t read_cnthctl_el2(void) { return 0; }
+static inline void write_cnthctl_el2(u_register_t v) { (void)v; }
+
+static inline void isb(void) { __atomic_signal_fence(__ATOMIC_SEQ_CST); }
+static inline void dsbsy(void) { __atomic_thread_fence(__ATOMIC_SEQ_CST); }
+static inline void dsbish(void) { __atomic_thread_fence(__ATOMIC_SEQ_CST); }
+static inline void dsbishst(void) { __atomic_thread_fence(__ATOMIC_SEQ_CST); }
+static inline void dmbsy(void) { __atomic_thread_fence(__ATOMIC_SEQ_CST); }
+static inline void dmbish(void) { __atomic_thread_fence(__ATOMIC_SEQ_CST); }
+static inline void dmbst(void) { __atomic_thread_fence(__ATOMIC_RELEASE); }
+static inline void dmbld(void) { __atomic_thread_fence(__ATOMIC_ACQUIRE); }
+
+/* Threads outnumber host CPUs: let the others run instead of sleeping */
+static inline void wfe(void) { sched_yield(); }
+static inline void sev(void) { }
+
+#endif /* ARCH_HELPERS_H */
@@ -0,0 +1,10 @@
+/*
+ * Host stand-in for the TF-A header, which also brings in debug.h.
+ */
+#ifndef SIM_ASSERT_H
+#define SIM_ASSERT_H
+
+#include_next <assert.h>
+#include <debug.h>
+
+#endif /* SIM_ASSERT_H */
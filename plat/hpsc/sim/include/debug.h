@@ -0,0 +1,17 @@
+/*
+ * Host stand-in for the TF-A header, for the simulated mailbox stack.
+ * Only warnings and errors are printed, so that console output does not
+ * distort the measurements.
+ */
+#ifndef DEBUG_H
+#define DEBUG_H
+
+#include <stdio.h>
+
+#define ERROR(...)	fprintf(stderr, "ERROR:   " __VA_ARGS__)
+#define WARN(...)	fprintf(stderr, "WARNING: " __VA_ARGS__)
+#define NOTICE(...)	do { } while (0)
+#define INFO(...)	do { } while (0)
+#define VERBOSE(...)	do { } while (0)
+
+#endif /* DEBUG_H */
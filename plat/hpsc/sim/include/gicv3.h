@@ -0,0 +1,6 @@
+/*
+ * Host stand-in for the TF-A header, for the simulated mailbox stack.
+ */
+#ifndef GICV3_H
+#define GICV3_H
+#endif /* GICV3_H */
@@ -0,0 +1,34 @@
+/*
+ * Host stand-in for the TF-A header, for the simulated mailbox stack:
+ * register accesses go to the model of the mailbox IP block (sim_mbox.c).
+ */
+#ifndef MMIO_H
+#define MMIO_H
+
+#include <stdint.h>
+
+uint32_t sim_mmio_read_32(uintptr_t addr);
+void sim_mmio_write_32(uintptr_t addr, uint32_t value);
+void sim_mmio_clrsetbits_32(uintptr_t addr, uint32_t clear, uint32_t set);
+
+static inline uint32_t mmio_read_32(uintptr_t addr)
+{
+	return sim_mmio_read_32(addr);
+}
+
+static inline void mmio_write_32(uintptr_t addr, uint32_t value)
+{
+	sim_mmio_write_32(addr, value);
+}
+
+static inline void mmio_clrbits_32(uintptr_t addr, uint32_t clear)
+{
+	sim_mmio_clrsetbits_32(addr, clear, 0);
+}
+
+static inline void mmio_setbits_32(uintptr_t addr, uint32_t set)
+{
+	sim_mmio_clrsetbits_32(addr, 0, set);
+}
+
+#endif /* MMIO_H */
@@ -0,0 +1,26 @@
+/*
+ * Host stand-in for the TF-A header, for the simulated mailbox stack.
+ * Each thread of the simulation plays one core.
+ */
+#ifndef PLATFORM_H
+#define PLATFORM_H
+
+#include <debug.h>
+
+#ifndef PLATFORM_CORE_COUNT
+#define PLATFORM_CORE_COUNT	8
+#endif
+
+extern __thread unsigned int sim_core_pos;
+
+static inline unsigned int plat_my_core_pos(void)
+{
+	return sim_core_pos;
+}
+
+static inline unsigned int plat_get_syscnt_freq2(void)
+{
+	return 125000000;
+}
+
+#endif /* PLATFORM_H */
@@ -0,0 +1,25 @@
+/*
+ * Host stand-in for the TF-A header, for the simulated mailbox stack.
+ */
+#ifndef SPINLOCK_H
+#define SPINLOCK_H
+
+#include <sched.h>
+#include <stdint.h>
+
+typedef struct spinlock {
+	volatile uint32_t lock;
+} spinlock_t;
+
+static inline void spin_lock(spinlock_t *lock)
+{
+	while (__atomic_exchange_n(&lock->lock, 1, __ATOMIC_ACQUIRE))
+		sched_yield();
+}
+
+static inline void spin_unlock(spinlock_t *lock)
+{
+	__atomic_store_n(&lock->lock, 0, __ATOMIC_RELEASE);
+}
+
+#endif /* SPINLOCK_H */
@@ -0,0 +1,12 @@
+/*
+ * Host stand-in for the TF-A header, for the simulated mailbox stack.
+ */
+#ifndef UTILS_DEF_H
+#define UTILS_DEF_H
+
+#define U(_x)		(_x##U)
+#define ARRAY_SIZE(a)	(sizeof(a) / sizeof((a)[0]))
+#define CASSERT(cond, msg)	\
+	typedef char msg[(cond) ? 1 : -1] __attribute__((unused))
+
+#endif /* UTILS_DEF_H */
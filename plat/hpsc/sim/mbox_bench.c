@@ -0,0 +1,309 @@
+#include <getopt.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <arch_helpers.h>
+#include <platform.h>
+#include <utils_def.h>
+
+#include "command.h"
+#include "hpsc-busids.dtsh"
+#include "link.h"
+#include "mailbox.h"
+#include "mailbox-link.h"
+#include "mailbox-map.h"
+#include "sim.h"
+
+// Host benchmark of the mailbox stack: each thread plays an HPPS core that
+// issues PING requests to the simulated TRCH server through the ATF link of
+// its core (or through one shared link), keeping up to 'depth' requests in
+// flight, and measures the latency from request_async to the end of wait.
+// It fails if a reply is handed to the wrong request, or if requests time out
+// other than those that the server dropped (see -d), so that it can check
+// that the links recover from lost replies.
+
+#define MAX_DEPTH 8 // outstanding requests per link (mailbox-link.c)
+#define REQ_WORDS 4
+
+struct client_link {
+    const char *name;
+    unsigned idx_from; // TRCH -> HPPS
+    unsigned idx_to;   // HPPS -> TRCH
+    unsigned client;
+};
+
+static const struct client_link client_links[] = {
+    { "HPPS_ATF(CPU0)->TRCH", MBOX_HPPS_TRCH__TRCH_ATF_HPPS,
+      MBOX_HPPS_TRCH__HPPS_ATF_TRCH, MASTER_ID_HPPS_CPU0 },
+    { "HPPS_ATF(CPU1)->TRCH", MBOX_HPPS_TRCH__TRCH_ATF_HPPS_CPU1,
+      MBOX_HPPS_TRCH__HPPS_ATF_TRCH_CPU1, MASTER_ID_HPPS_CPU1 },
+    { "HPPS_ATF(CPU2)->TRCH", MBOX_HPPS_TRCH__TRCH_ATF_HPPS_CPU2,
+      MBOX_HPPS_TRCH__HPPS_ATF_TRCH_CPU2, MASTER_ID_HPPS_CPU2 },
+    { "HPPS_ATF(CPU3)->TRCH", MBOX_HPPS_TRCH__TRCH_ATF_HPPS_CPU3,
+      MBOX_HPPS_TRCH__HPPS_ATF_TRCH_CPU3, MASTER_ID_HPPS_CPU3 },
+    { "HPPS_ATF(CPU4)->TRCH", MBOX_HPPS_TRCH__TRCH_ATF_HPPS_CPU4,
+      MBOX_HPPS_TRCH__HPPS_ATF_TRCH_CPU4, MASTER_ID_HPPS_CPU4 },
+    { "HPPS_ATF(CPU5)->TRCH", MBOX_HPPS_TRCH__TRCH_ATF_HPPS_CPU5,
+      MBOX_HPPS_TRCH__HPPS_ATF_TRCH_CPU5, MASTER_ID_HPPS_CPU5 },
+    { "HPPS_ATF(CPU6)->TRCH", MBOX_HPPS_TRCH__TRCH_ATF_HPPS_CPU6,
+      MBOX_HPPS_TRCH__HPPS_ATF_TRCH_CPU6, MASTER_ID_HPPS_CPU6 },
+    { "HPPS_ATF(CPU7)->TRCH", MBOX_HPPS_TRCH__TRCH_ATF_HPPS_CPU7,
+      MBOX_HPPS_TRCH__HPPS_ATF_TRCH_CPU7, MASTER_ID_HPPS_CPU7 },
+};
+
+struct client {
+    pthread_t thread;
+    unsigned core;
+    struct link *link;
+    uint64_t *lat; // ticks, one per request
+    unsigned completed;
+    unsigned send_errors;
+    unsigned timeouts;
+    unsigned mismatches;
+};
+
+static unsigned threads = 1;
+static unsigned requests = 10000;
+static unsigned depth = 1;
+static bool shared_link = false;
+static bool irq_driven = false;
+static unsigned service_ns = 0;
+static unsigned rcv_lines = SIM_TRCH_RCV_LINES;
+static int timeout_ms = CMD_TIMEOUT_MS_RECV;
+static unsigned drop_every = 0;
+static bool echo_tags = true;
+
+static struct client clients[PLATFORM_CORE_COUNT];
+
+struct inflight {
+    int tag;
+    uint32_t seq;
+    uint64_t start;
+    uint32_t reply[HPSC_MBOX_DATA_REGS];
+};
+
+static void client_complete(struct client *c, struct inflight *f)
+{
+    int rc;
+
+    rc = c->link->wait(c->link, f->tag, timeout_ms, NULL);
+    if (rc <= 0) {
+        c->timeouts++;
+        return;
+    }
+    c->lat[c->completed++] = read_cntpct_el0() - f->start;
+    if (rc < 2 * (int)sizeof(uint32_t) ||
+        f->reply[0] != CMD_PONG || f->reply[1] != f->seq)
+        c->mismatches++;
+}
+
+static void *client_loop(void *arg)
+{
+    struct client *c = arg;
+    struct inflight fl[MAX_DEPTH];
+    uint32_t msg[REQ_WORDS];
+    unsigned issued, head = 0, tail = 0, i;
+
+    sim_core_pos = c->core;
+    for (issued = 0; issued < requests; ++issued) {
+        if (head - tail == depth)
+            client_complete(c, &fl[tail++ % MAX_DEPTH]);
+
+        struct inflight *f = &fl[head % MAX_DEPTH];
+        f->seq = (c->core << 24) | issued;
+        msg[0] = CMD_PING;
+        msg[1] = f->seq;
+        for (i = 2; i < REQ_WORDS; ++i)
+            msg[i] = i;
+        f->start = read_cntpct_el0();
+        f->tag = c->link->request_async(c->link, CMD_TIMEOUT_MS_SEND,
+                                        msg, sizeof(msg),
+                                        f->reply, sizeof(f->reply));
+        if (f->tag < 0) {
+            c->send_errors++;
+            continue;
+        }
+        ++head;
+    }
+    while (tail != head)
+        client_complete(c, &fl[tail++ % MAX_DEPTH]);
+    return NULL;
+}
+
+// The simulated interrupt lines are always taken, by their own threads
+static void client_irq_poll(void)
+{
+}
+
+static int cmp_u64(const void *a, const void *b)
+{
+    uint64_t x = *(const uint64_t *)a, y = *(const uint64_t *)b;
+    return x < y ? -1 : x > y;
+}
+
+static double ticks_to_us(uint64_t ticks)
+{
+    return (double)ticks * 1000000.0 / plat_get_syscnt_freq2();
+}
+
+// Returns non-zero if requests failed other than as injected
+static int report(uint64_t elapsed)
+{
+    struct cmd_queue_stats qs;
+    struct sim_mbox_stats ms;
+    uint64_t *all;
+    unsigned n = 0, send_errors = 0, timeouts = 0, mismatches = 0, dropped, i;
+    static const double pcts[] = { 50.0, 90.0, 99.0, 99.9 };
+
+    all = malloc(sizeof(*all) * threads * requests);
+    if (!all) {
+        perror("malloc");
+        exit(1);
+    }
+    for (i = 0; i < threads; ++i) {
+        memcpy(&all[n], clients[i].lat, sizeof(*all) * clients[i].completed);
+        n += clients[i].completed;
+        send_errors += clients[i].send_errors;
+        timeouts += clients[i].timeouts;
+        mismatches += clients[i].mismatches;
+    }
+    qsort(all, n, sizeof(*all), cmp_u64);
+
+    printf("threads %u requests/thread %u depth %u links %u (%s) rcv lines %u "
+           "service %u ns%s\n", threads, requests, depth, shared_link ? 1 : threads,
+           irq_driven ? "interrupts" : "polled", rcv_lines, service_ns,
+           echo_tags ? "" : " untagged");
+    printf("completed %u in %.3f ms: %.0f req/s\n", n,
+           ticks_to_us(elapsed) / 1000.0,
+           elapsed ? n / (ticks_to_us(elapsed) / 1000000.0) : 0.0);
+    if (n) {
+        printf("latency (us):");
+        for (i = 0; i < ARRAY_SIZE(pcts); ++i)
+            printf(" p%g %.1f", pcts[i],
+                   ticks_to_us(all[(unsigned)(pcts[i] / 100.0 * (n - 1))]));
+        printf(" max %.1f\n", ticks_to_us(all[n - 1]));
+    }
+    printf("errors: send %u timeout %u mismatch %u\n",
+           send_errors, timeouts, mismatches);
+
+    cmd_queue_get_stats(&qs);
+    printf("cmd queue: enqueued %u batches %u full %u max depth %u\n",
+           qs.enqueued, qs.batches, qs.full, qs.max_depth);
+    sim_mbox_get_stats(&ms);
+    printf("mailbox: reads %lu writes %lu interrupts %lu\n",
+           (unsigned long)ms.reads, (unsigned long)ms.writes,
+           (unsigned long)ms.interrupts);
+    dropped = sim_server_dropped();
+    printf("server: dropped %u\n", dropped);
+    free(all);
+
+    // a full command queue drops requests too
+    return send_errors || mismatches || timeouts != dropped + qs.full;
+}
+
+static void usage(const char *prog)
+{
+    fprintf(stderr,
+            "usage: %s [-t threads] [-n requests] [-q depth] [-s] [-I] [-l service_ns]\n"
+            "       [-i rcv_lines] [-T timeout_ms] [-d drop_every] [-U]\n"
+            "  -t  client threads, one per HPPS core (1..%u)\n"
+            "  -n  requests per thread\n"
+            "  -q  requests in flight per thread (1..%u)\n"
+            "  -s  all threads share the link of CPU0\n"
+            "  -I  complete requests from the HPPS mailbox interrupts, not by polling\n"
+            "  -l  time the server spends on each request\n"
+            "  -i  interrupt lines that the server links are spread over (1..%u)\n"
+            "  -T  reply timeout\n"
+            "  -d  the server drops every drop_every-th request without a reply\n"
+            "  -U  the server does not echo the tags of the requests\n",
+            prog, PLATFORM_CORE_COUNT, MAX_DEPTH, SIM_TRCH_RCV_LINES);
+    exit(2);
+}
+
+int main(int argc, char **argv)
+{
+    struct irq *rcv_irq, *ack_irq;
+    unsigned links, i;
+    uint64_t start;
+    int opt, rc;
+
+    while ((opt = getopt(argc, argv, "t:n:q:sIl:i:T:d:Uh")) != -1) {
+        switch (opt) {
+        case 't': threads = strtoul(optarg, NULL, 0); break;
+        case 'n': requests = strtoul(optarg, NULL, 0); break;
+        case 'q': depth = strtoul(optarg, NULL, 0); break;
+        case 's': shared_link = true; break;
+        case 'I': irq_driven = true; break;
+        case 'l': service_ns = strtoul(optarg, NULL, 0); break;
+        case 'i': rcv_lines = strtoul(optarg, NULL, 0); break;
+        case 'T': timeout_ms = strtol(optarg, NULL, 0); break;
+        case 'd': drop_every = strtoul(optarg, NULL, 0); break;
+        case 'U': echo_tags = false; break;
+        default: usage(argv[0]);
+        }
+    }
+    links = shared_link ? 1 : threads;
+    if (!threads || threads > PLATFORM_CORE_COUNT || !requests ||
+        !depth || depth > MAX_DEPTH || !rcv_lines || rcv_lines > SIM_TRCH_RCV_LINES)
+        usage(argv[0]);
+    if ((threads / links) * depth > MAX_DEPTH) {
+        fprintf(stderr, "%u threads x depth %u exceed the %u requests a link "
+                "can have outstanding\n", threads / links, depth, MAX_DEPTH);
+        return 2;
+    }
+
+    // the server claims (owns) the mailboxes, so it connects first
+    sim_server_set_faults(drop_every, echo_tags);
+    if (sim_server_start(links, rcv_lines, service_ns)) {
+        fprintf(stderr, "failed to start the server\n");
+        return 1;
+    }
+    // Unless interrupt-driven, the HPPS lines are not serviced (as in EL3)
+    rcv_irq = sim_irq_request(MBOX_HPPS_TRCH__HPPS_RCV_ATF_INT,
+                              irq_driven ? mbox_rcv_isr : NULL);
+    ack_irq = sim_irq_request(MBOX_HPPS_TRCH__HPPS_ACK_ATF_INT,
+                              irq_driven ? mbox_ack_isr : NULL);
+    for (i = 0; i < links; ++i) {
+        clients[i].link = mbox_link_connect(client_links[i].name,
+                sim_mbox_base(SIM_SIDE_HPPS),
+                client_links[i].idx_from, client_links[i].idx_to,
+                rcv_irq, MBOX_HPPS_TRCH__HPPS_RCV_ATF_INT,
+                ack_irq, MBOX_HPPS_TRCH__HPPS_ACK_ATF_INT,
+                0, client_links[i].client);
+        if (!clients[i].link) {
+            fprintf(stderr, "failed to connect %s\n", client_links[i].name);
+            return 1;
+        }
+        if (irq_driven)
+            mbox_link_set_irq_poll(clients[i].link, client_irq_poll);
+    }
+
+    for (i = 0; i < threads; ++i) {
+        clients[i].core = i;
+        clients[i].link = clients[shared_link ? 0 : i].link;
+        clients[i].lat = calloc(requests, sizeof(*clients[i].lat));
+        if (!clients[i].lat) {
+            perror("calloc");
+            return 1;
+        }
+    }
+
+    start = read_cntpct_el0();
+    for (i = 0; i < threads; ++i)
+        if (pthread_create(&clients[i].thread, NULL, client_loop, &clients[i])) {
+            perror("pthread_create");
+            return 1;
+        }
+    for (i = 0; i < threads; ++i)
+        pthread_join(clients[i].thread, NULL);
+    rc = report(read_cntpct_el0() - start);
+
+    sim_server_stop();
+    sim_mbox_stop();
+    for (i = 0; i < threads; ++i)
+        free(clients[i].lat);
+    return rc;
+}
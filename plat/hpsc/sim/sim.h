@@ -0,0 +1,55 @@
+#ifndef SIM_H
+#define SIM_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "intc.h"
+
+// Host simulation of the HPPS-TRCH mailbox IP block (sim_mbox.c) and of the
+// TRCH side of the ATF links (sim_server.c), for running the mailbox stack
+// of plat/hpsc/hpsc_mailbox off-target.
+
+#define SIM_MBOX_INSTANCES 32
+#define SIM_MBOX_INTS      16
+
+// Interrupt lines of the TRCH side: inbound commands are spread over up to
+// SIM_TRCH_RCV_LINES lines, so that their ISRs run on as many threads
+#define SIM_TRCH_ACK_INT       1
+#define SIM_TRCH_RCV_INT(n)    (8 + (n))
+#define SIM_TRCH_RCV_LINES     8
+
+// Both sides see the same instances, each at its own address
+enum sim_side {
+    SIM_SIDE_HPPS,
+    SIM_SIDE_TRCH,
+    SIM_SIDES,
+};
+
+struct sim_mbox_stats {
+    uint64_t reads;
+    uint64_t writes;
+    uint64_t interrupts; // ISR invocations
+};
+
+volatile uint32_t *sim_mbox_base(enum sim_side side);
+// Attach an ISR to an interrupt line of the block; it runs on a thread of
+// its own whenever the line is raised (level-triggered). Without an ISR, the
+// line is never taken, as in EL3, and the mailboxes mapped to it are polled.
+struct irq *sim_irq_request(unsigned int_idx, void (*isr)(unsigned int_idx));
+void sim_mbox_stop(void);
+void sim_mbox_get_stats(struct sim_mbox_stats *stats);
+
+// Stand-in TRCH server: answers CMD_PING with CMD_PONG and the arguments of
+// the request, after spinning for service_ns
+int sim_server_start(unsigned links, unsigned rcv_lines, unsigned service_ns);
+// Faults, set before the server starts: drop every drop_every-th request
+// without a reply (0: none), and unless echo_tags, answer like a TRCH that
+// does not echo the tags of the requests
+void sim_server_set_faults(unsigned drop_every, bool echo_tags);
+unsigned sim_server_dropped(void);
+void sim_server_stop(void);
+
+extern __thread unsigned int sim_core_pos;
+
+#endif // SIM_H
@@ -0,0 +1,275 @@
+#include <assert.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <mmio.h>
+
+#include "mailbox.h"
+#include "sim.h"
+
+// Register layout of an instance and event bits, as seen by mailbox.c
+#define REG_CONFIG              0x00
+#define REG_EVENT_CAUSE         0x04 // read
+#define REG_EVENT_CLEAR         0x04 // write
+#define REG_EVENT_STATUS        0x08 // read
+#define REG_EVENT_SET           0x08 // write
+#define REG_INT_ENABLE          0x0C
+#define REG_DATA                0x10
+#define INSTANCE_REGION (REG_DATA + HPSC_MBOX_DATA_SIZE)
+
+#define EVENT_A 0x1 // rcv
+#define EVENT_B 0x2 // ack
+// interrupt enable bits that map event A (B) to interrupt 'idx'
+#define INT_A(idx) (1u << (2 * (idx)))
+#define INT_B(idx) (1u << (2 * (idx) + 1))
+#define INT_A_ANY 0x55555555u
+#define INT_B_ANY 0xaaaaaaaau
+
+struct sim_instance {
+    uint32_t config;
+    uint32_t status;
+    uint32_t int_enable;
+    uint32_t data[HPSC_MBOX_DATA_REGS];
+};
+
+struct irq {
+    unsigned n;
+    void (*isr)(unsigned int_idx);
+    bool raised;
+    pthread_t thread;
+};
+
+__thread unsigned int sim_core_pos;
+
+// Only the addresses matter: accesses are decoded relative to this array.
+// Each side maps the block at an address of its own, since the mailbox
+// driver keeps one state per block address.
+#define BLOCK_SIZE (SIM_MBOX_INSTANCES * INSTANCE_REGION)
+static uint8_t sim_space[SIM_SIDES * BLOCK_SIZE];
+static struct sim_instance insts[SIM_MBOX_INSTANCES];
+static struct irq lines[SIM_MBOX_INTS];
+static struct sim_mbox_stats stats;
+static bool stopping;
+static pthread_mutex_t sim_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t sim_cond = PTHREAD_COND_INITIALIZER;
+
+volatile uint32_t *sim_mbox_base(enum sim_side side)
+{
+    assert(side < SIM_SIDES);
+    return (volatile uint32_t *)&sim_space[side * BLOCK_SIZE];
+}
+
+static struct sim_instance *decode(uintptr_t addr, unsigned *reg)
+{
+    uintptr_t off = addr - (uintptr_t)sim_space;
+
+    assert(addr >= (uintptr_t)sim_space && off < sizeof(sim_space));
+    assert(!(off % sizeof(uint32_t)));
+    off %= BLOCK_SIZE;
+    *reg = off % INSTANCE_REGION;
+    return &insts[off / INSTANCE_REGION];
+}
+
+// A line is high while some instance has an event mapped to it
+static bool line_level(unsigned idx)
+{
+    struct sim_instance *in;
+    unsigned i;
+
+    for (i = 0; i < SIM_MBOX_INSTANCES; ++i) {
+        in = &insts[i];
+        if (((in->status & EVENT_A) && (in->int_enable & INT_A(idx))) ||
+            ((in->status & EVENT_B) && (in->int_enable & INT_B(idx))))
+            return true;
+    }
+    return false;
+}
+
+static void raise_lines(struct sim_instance *in)
+{
+    unsigned idx;
+    bool raised = false;
+
+    for (idx = 0; idx < SIM_MBOX_INTS; ++idx) {
+        if (!lines[idx].isr)
+            continue;
+        if (((in->status & EVENT_A) && (in->int_enable & INT_A(idx))) ||
+            ((in->status & EVENT_B) && (in->int_enable & INT_B(idx)))) {
+            lines[idx].raised = true;
+            raised = true;
+        }
+    }
+    if (raised)
+        pthread_cond_broadcast(&sim_cond);
+}
+
+static uint32_t reg_read_locked(struct sim_instance *in, unsigned reg)
+{
+    uint32_t mask = 0;
+
+    switch (reg) {
+    case REG_CONFIG:
+        return in->config;
+    case REG_EVENT_CAUSE:
+        if (in->int_enable & INT_A_ANY)
+            mask |= EVENT_A;
+        if (in->int_enable & INT_B_ANY)
+            mask |= EVENT_B;
+        return in->status & mask;
+    case REG_EVENT_STATUS:
+        return in->status;
+    case REG_INT_ENABLE:
+        return in->int_enable;
+    default:
+        return in->data[(reg - REG_DATA) / sizeof(uint32_t)];
+    }
+}
+
+static void reg_write_locked(struct sim_instance *in, unsigned reg, uint32_t val)
+{
+    switch (reg) {
+    case REG_CONFIG:
+        in->config = val;
+        break;
+    case REG_EVENT_CLEAR:
+        in->status &= ~val;
+        break;
+    case REG_EVENT_SET:
+        in->status |= val & (EVENT_A | EVENT_B);
+        raise_lines(in);
+        break;
+    case REG_INT_ENABLE:
+        in->int_enable = val;
+        raise_lines(in);
+        break;
+    default:
+        in->data[(reg - REG_DATA) / sizeof(uint32_t)] = val;
+        break;
+    }
+}
+
+uint32_t sim_mmio_read_32(uintptr_t addr)
+{
+    struct sim_instance *in;
+    unsigned reg;
+    uint32_t val;
+
+    pthread_mutex_lock(&sim_lock);
+    in = decode(addr, &reg);
+    val = reg_read_locked(in, reg);
+    stats.reads++;
+    pthread_mutex_unlock(&sim_lock);
+    return val;
+}
+
+void sim_mmio_write_32(uintptr_t addr, uint32_t value)
+{
+    struct sim_instance *in;
+    unsigned reg;
+
+    pthread_mutex_lock(&sim_lock);
+    in = decode(addr, &reg);
+    reg_write_locked(in, reg, value);
+    stats.writes++;
+    pthread_mutex_unlock(&sim_lock);
+}
+
+void sim_mmio_clrsetbits_32(uintptr_t addr, uint32_t clear, uint32_t set)
+{
+    struct sim_instance *in;
+    unsigned reg;
+
+    pthread_mutex_lock(&sim_lock);
+    in = decode(addr, &reg);
+    // the event registers read and write different things
+    assert(reg != REG_EVENT_CLEAR && reg != REG_EVENT_SET);
+    reg_write_locked(in, reg, (reg_read_locked(in, reg) & ~clear) | set);
+    stats.reads++;
+    stats.writes++;
+    pthread_mutex_unlock(&sim_lock);
+}
+
+// Stand-in for the interrupt controller and the core taking the interrupt
+static void *line_thread(void *arg)
+{
+    struct irq *irq = arg;
+
+    pthread_mutex_lock(&sim_lock);
+    while (!stopping) {
+        if (!irq->raised) {
+            pthread_cond_wait(&sim_cond, &sim_lock);
+            continue;
+        }
+        irq->raised = false;
+        // the event may have been consumed by polling meanwhile
+        if (!line_level(irq->n))
+            continue;
+        pthread_mutex_unlock(&sim_lock);
+        irq->isr(irq->n);
+        pthread_mutex_lock(&sim_lock);
+        stats.interrupts++;
+        if (line_level(irq->n))
+            irq->raised = true;
+    }
+    pthread_mutex_unlock(&sim_lock);
+    return NULL;
+}
+
+struct irq *sim_irq_request(unsigned int_idx, void (*isr)(unsigned int_idx))
+{
+    struct irq *irq;
+
+    assert(int_idx < SIM_MBOX_INTS);
+    irq = &lines[int_idx];
+    irq->n = int_idx;
+    if (irq->isr || !isr) { // no ISR: the line is left unserviced and polled
+        assert(!isr || irq->isr == isr);
+        return irq;
+    }
+    irq->isr = isr;
+    if (pthread_create(&irq->thread, NULL, line_thread, irq)) {
+        irq->isr = NULL;
+        return NULL;
+    }
+    return irq;
+}
+
+void sim_mbox_stop(void)
+{
+    unsigned i;
+
+    pthread_mutex_lock(&sim_lock);
+    stopping = true;
+    pthread_cond_broadcast(&sim_cond);
+    pthread_mutex_unlock(&sim_lock);
+    for (i = 0; i < SIM_MBOX_INTS; ++i)
+        if (lines[i].isr)
+            pthread_join(lines[i].thread, NULL);
+}
+
+void sim_mbox_get_stats(struct sim_mbox_stats *s)
+{
+    pthread_mutex_lock(&sim_lock);
+    *s = stats;
+    pthread_mutex_unlock(&sim_lock);
+}
+
+static void sim_int_enable(struct irq *irq) { }
+static void sim_int_disable(struct irq *irq) { }
+static void sim_disable_all(void) { }
+static unsigned sim_int_num(struct irq *irq) { return irq->n; }
+static unsigned sim_int_type(struct irq *irq) { return 0; }
+
+static const struct intc_ops sim_intc_ops = {
+    .int_enable = sim_int_enable,
+    .int_disable = sim_int_disable,
+    .disable_all = sim_disable_all,
+    .int_num = sim_int_num,
+    .int_type = sim_int_type,
+};
+
+static void __attribute__((constructor)) sim_intc_init(void)
+{
+    intc_register(&sim_intc_ops);
+}
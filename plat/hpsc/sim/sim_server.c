@@ -0,0 +1,141 @@
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <arch_helpers.h>
+#include <debug.h>
+#include <platform.h>
+#include <utils_def.h>
+
+#include "command.h"
+#include "hpsc-busids.dtsh"
+#include "link.h"
+#include "mailbox.h"
+#include "mailbox-link.h"
+#include "mailbox-map.h"
+#include "sim.h"
+
+// Mailbox pairs of the per-core ATF links, as assigned by pm_ipi.c
+static const struct {
+    const char *name;
+    unsigned idx_from; // HPPS -> TRCH
+    unsigned idx_to;   // TRCH -> HPPS
+    unsigned client;
+} sim_link_descs[] = {
+    { "TRCH->HPPS_ATF(CPU0)", MBOX_HPPS_TRCH__HPPS_ATF_TRCH,
+      MBOX_HPPS_TRCH__TRCH_ATF_HPPS, MASTER_ID_HPPS_CPU0 },
+    { "TRCH->HPPS_ATF(CPU1)", MBOX_HPPS_TRCH__HPPS_ATF_TRCH_CPU1,
+      MBOX_HPPS_TRCH__TRCH_ATF_HPPS_CPU1, MASTER_ID_HPPS_CPU1 },
+    { "TRCH->HPPS_ATF(CPU2)", MBOX_HPPS_TRCH__HPPS_ATF_TRCH_CPU2,
+      MBOX_HPPS_TRCH__TRCH_ATF_HPPS_CPU2, MASTER_ID_HPPS_CPU2 },
+    { "TRCH->HPPS_ATF(CPU3)", MBOX_HPPS_TRCH__HPPS_ATF_TRCH_CPU3,
+      MBOX_HPPS_TRCH__TRCH_ATF_HPPS_CPU3, MASTER_ID_HPPS_CPU3 },
+    { "TRCH->HPPS_ATF(CPU4)", MBOX_HPPS_TRCH__HPPS_ATF_TRCH_CPU4,
+      MBOX_HPPS_TRCH__TRCH_ATF_HPPS_CPU4, MASTER_ID_HPPS_CPU4 },
+    { "TRCH->HPPS_ATF(CPU5)", MBOX_HPPS_TRCH__HPPS_ATF_TRCH_CPU5,
+      MBOX_HPPS_TRCH__TRCH_ATF_HPPS_CPU5, MASTER_ID_HPPS_CPU5 },
+    { "TRCH->HPPS_ATF(CPU6)", MBOX_HPPS_TRCH__HPPS_ATF_TRCH_CPU6,
+      MBOX_HPPS_TRCH__TRCH_ATF_HPPS_CPU6, MASTER_ID_HPPS_CPU6 },
+    { "TRCH->HPPS_ATF(CPU7)", MBOX_HPPS_TRCH__HPPS_ATF_TRCH_CPU7,
+      MBOX_HPPS_TRCH__TRCH_ATF_HPPS_CPU7, MASTER_ID_HPPS_CPU7 },
+};
+
+static unsigned server_service_ns;
+static unsigned server_drop_every;
+static bool server_echo_tags = true;
+static unsigned server_requests;
+static volatile bool server_stopping;
+static pthread_t server_thread;
+
+static int sim_server_handle(struct cmd *cmd, uint32_t *reply, size_t reply_size)
+{
+    uint64_t until;
+    size_t i;
+
+    if (cmd->msg[0] != CMD_PING) {
+        WARN("sim server: unexpected command %u\r\n", cmd->msg[0]);
+        return -1;
+    }
+
+    // only the server thread handles requests
+    if (server_drop_every && ++server_requests % server_drop_every == 0)
+        return 0;
+    // cmd_handle echoes the tag word only if it is marked as such
+    if (!server_echo_tags)
+        cmd->msg[MBOX_LINK_TAG_WORD] = 0;
+
+    until = read_cntpct_el0() +
+            (uint64_t)server_service_ns * (plat_get_syscnt_freq2() / 1000000) / 1000;
+    while (read_cntpct_el0() < until)
+        ;
+
+    reply[0] = CMD_PONG;
+    for (i = 1; i < reply_size; ++i)
+        reply[i] = cmd->msg[i];
+    return reply_size;
+}
+
+// The TRCH main loop: drain the queue that the receive ISRs fill
+static void *sim_server_loop(void *arg)
+{
+    struct cmd cmds[4];
+    size_t n, i;
+
+    while (!server_stopping) {
+        n = cmd_dequeue_batch(cmds, ARRAY_SIZE(cmds));
+        for (i = 0; i < n; ++i)
+            cmd_handle(&cmds[i]);
+        if (!n)
+            wfe();
+    }
+    return NULL;
+}
+
+void sim_server_set_faults(unsigned drop_every, bool echo_tags)
+{
+    server_drop_every = drop_every;
+    server_echo_tags = echo_tags;
+}
+
+unsigned sim_server_dropped(void)
+{
+    return server_drop_every ? server_requests / server_drop_every : 0;
+}
+
+int sim_server_start(unsigned links, unsigned rcv_lines, unsigned service_ns)
+{
+    struct irq *rcv_irq, *ack_irq;
+    unsigned i, line;
+
+    if (!links || links > ARRAY_SIZE(sim_link_descs) ||
+        !rcv_lines || rcv_lines > SIM_TRCH_RCV_LINES)
+        return -1;
+
+    server_service_ns = service_ns;
+    cmd_handler_register(sim_server_handle);
+
+    // cmd_handle polls for the ACKs of the replies: no ISR needed
+    ack_irq = sim_irq_request(SIM_TRCH_ACK_INT, NULL);
+    for (i = 0; i < links; ++i) {
+        line = SIM_TRCH_RCV_INT(i % rcv_lines);
+        rcv_irq = sim_irq_request(line, mbox_rcv_isr);
+        if (!rcv_irq ||
+            !mbox_link_connect(sim_link_descs[i].name, sim_mbox_base(SIM_SIDE_TRCH),
+                               sim_link_descs[i].idx_from,
+                               sim_link_descs[i].idx_to,
+                               rcv_irq, line, ack_irq, SIM_TRCH_ACK_INT,
+                               MASTER_ID_TRCH_CPU, sim_link_descs[i].client)) {
+            ERROR("sim server: failed to connect %s\r\n", sim_link_descs[i].name);
+            return -1;
+        }
+    }
+
+    server_stopping = false;
+    return pthread_create(&server_thread, NULL, sim_server_loop, NULL) ? -1 : 0;
+}
+
+void sim_server_stop(void)
+{
+    server_stopping = true;
+    pthread_join(server_thread, NULL);
+    cmd_handler_unregister();
+}
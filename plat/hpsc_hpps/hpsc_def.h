@@ -79,8 +79,17 @@
 #define ARM_CONSOLE_BAUDRATE	HPSC_UART_BAUDRATE
 
 #if TRCH_SERVER
+#include <hpsc-irqs.dtsh>
+#include <mailbox-map.h>
+
 #define HPPS_RCV_IRQ_IDX  MBOX_HPPS_TRCH__HPPS_RCV_ATF_INT	/* 4 */
 #define HPPS_ACK_IRQ_IDX  MBOX_HPPS_TRCH__HPPS_ACK_ATF_INT	/* 5 */
+
+/* GIC INTIDs of the above, Group 0 (taken in EL3) if HPSC_MBOX_IRQ */
+#define HPPS_RCV_INTID	(ARM_IRQ_SEC_SPI_0 + HPPS_IRQ__HT_MBOX_0 + \
+			 HPPS_RCV_IRQ_IDX)
+#define HPPS_ACK_INTID	(ARM_IRQ_SEC_SPI_0 + HPPS_IRQ__HT_MBOX_0 + \
+			 HPPS_ACK_IRQ_IDX)
 #endif /* TRCH_SERVER */
 
 #endif /* __HPSC_DEF_H__ */
@@ -57,12 +57,18 @@
 #define PLAT_ARM_NS_IMAGE_OFFSET	(HPSC_NEXT_IMAGE_BASE)
 #endif
 
+/* Non-secure buffer the PSCI statistics histograms are exported to */
+#ifdef HPSC_PSCI_STAT_BUF_BASE
+#define PLAT_PSCI_STAT_HIST_BUF_BASE	(HPSC_PSCI_STAT_BUF_BASE)
+#define PLAT_PSCI_STAT_HIST_BUF_SIZE	(HPSC_PSCI_STAT_BUF_SIZE)
+#endif
+
 /*******************************************************************************
  * Platform specific page table and MMU setup constants
  ******************************************************************************/
 #define PLAT_PHY_ADDR_SPACE_SIZE	(1ull << 32)
 #define PLAT_VIRT_ADDR_SPACE_SIZE	(1ull << 32)
-#define MAX_MMAP_REGIONS		7
+#define MAX_MMAP_REGIONS		8
 #define MAX_XLAT_TABLES			5
 
 #define CACHE_WRITEBACK_SHIFT   6
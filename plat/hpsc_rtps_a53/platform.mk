@@ -14,12 +14,25 @@ PSCI_EXTENDED_STATE_ID := 1
 A53_DISABLE_NON_TEMPORAL_HINT := 0
 SEPARATE_CODE_AND_RODATA := 1
 HPSC_WARM_RESTART := 0
+# A single core, which cannot take the mailbox interrupts while it waits
+HPSC_MBOX_IRQ := 0
 # Do not enable SVE
 ENABLE_SVE_FOR_NS	:= 0
 WORKAROUND_CVE_2017_5715	:=	0
 
 # Configurable via env vars or via makefiles included via make -f
 TRCH_SERVER ?= 0
+# Entries in the queue of inbound commands (power of two)
+HPSC_CMD_QUEUE_LEN ?= 16
+# Coalesce concurrent PSCI power requests into PM_BATCH messages (TRCH
+# must support PM_BATCH)
+HPSC_PM_BATCH ?= 0
+# Give each core its own mailbox link to TRCH (TRCH must serve the per-core
+# mailbox instances of mailbox-map.h); otherwise all cores share CPU0's link
+HPSC_MBOX_PER_CORE ?= 0
+# Build the bulk transfer link over the region at HPSC_SHM_BASE, for a user
+# to connect with shmem_link_connect()
+HPSC_SHM_LINK ?= 0
 
 ifdef HPSC_ATF_MEM_BASE
     $(eval $(call add_define,HPSC_ATF_MEM_BASE))
@@ -38,6 +51,30 @@ ifdef HPSC_NEXT_IMAGE_BASE
     $(eval $(call add_define,HPSC_NEXT_IMAGE_BASE))
 endif
 
+# Optional non-cacheable region shared with TRCH for bulk transfers
+ifdef HPSC_SHM_BASE
+    $(eval $(call add_define,HPSC_SHM_BASE))
+
+    ifndef HPSC_SHM_SIZE
+        $(error "HPSC_SHM_BASE defined without HPSC_SHM_SIZE")
+    endif
+    $(eval $(call add_define,HPSC_SHM_SIZE))
+else ifeq (${HPSC_SHM_LINK}, 1)
+    $(error "HPSC_SHM_LINK requires HPSC_SHM_BASE")
+endif
+
+# Non-secure region the PSCI statistics histograms are exported to
+ifdef HPSC_PSCI_STAT_BUF_BASE
+    $(eval $(call add_define,HPSC_PSCI_STAT_BUF_BASE))
+
+    ifndef HPSC_PSCI_STAT_BUF_SIZE
+        $(error "HPSC_PSCI_STAT_BUF_BASE defined without HPSC_PSCI_STAT_BUF_SIZE")
+    endif
+    $(eval $(call add_define,HPSC_PSCI_STAT_BUF_SIZE))
+else ifeq (${PSCI_STAT_HIST}, 1)
+    $(error "PSCI_STAT_HIST requires HPSC_PSCI_STAT_BUF_BASE")
+endif
+
 ifdef HPSC_WARM_RESTART
   $(eval $(call add_define,HPSC_WARM_RESTART))
 endif
@@ -50,6 +87,12 @@ ifdef TRCH_SERVER
   $(eval $(call add_define,TRCH_SERVER))
 endif
 
+$(eval $(call add_define,HPSC_CMD_QUEUE_LEN))
+$(eval $(call add_define,HPSC_PM_BATCH))
+$(eval $(call add_define,HPSC_MBOX_PER_CORE))
+$(eval $(call add_define,HPSC_SHM_LINK))
+$(eval $(call add_define,HPSC_MBOX_IRQ))
+
 PLAT_INCLUDES		:=	-Iinclude/plat/arm/common/			\
 				-Iinclude/plat/arm/common/aarch64/		\
 				-Iplat/hpsc/					\
@@ -97,4 +140,34 @@ BL31_SOURCES		+=	lib/cpus/aarch64/aem_generic.S		\
 				plat/hpsc/hpsc_mailbox/mailbox-link.c 	\
 				plat/hpsc/hpsc_mailbox/mem.c  		\
 				plat/hpsc/hpsc_mailbox/object.c 	\
+				plat/hpsc/hpsc_mailbox/sleep.c 	\
 				plat/hpsc_rtps_a53/topology.c 		\
+
+ifeq (${HPSC_SHM_LINK}, 1)
+BL31_SOURCES		+=	plat/hpsc/hpsc_mailbox/shmem-link.c
+endif
+
+ifneq ($(filter 1,${ENABLE_PMF} ${ENABLE_LOCK_STATS} ${PSCI_STAT_HIST} \
+		 ${PSCI_CPU_ON_BATCH} ${ENABLE_INTR_TRACE}),)
+BL31_SOURCES		+=	plat/hpsc/hpsc_sip_svc.c
+endif
+
+ifeq (${ENABLE_PMF}, 1)
+BL31_SOURCES		+=	lib/pmf/pmf_smc.c
+endif
+
+ifeq (${ENABLE_LOCK_STATS}, 1)
+BL31_SOURCES		+=	lib/locks/stat/lock_stat_smc.c
+endif
+
+ifeq (${ENABLE_INTR_TRACE}, 1)
+BL31_SOURCES		+=	bl31/intr_trace_smc.c
+endif
+
+ifeq (${PSCI_STAT_HIST}, 1)
+BL31_SOURCES		+=	lib/psci/psci_stat_hist_smc.c
+endif
+
+ifeq (${PSCI_CPU_ON_BATCH}, 1)
+BL31_SOURCES		+=	lib/psci/psci_cpu_on_batch_smc.c
+endif
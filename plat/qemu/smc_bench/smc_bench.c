@@ -0,0 +1,290 @@
+/*
+ * Copyright (c) 2018, ARM Limited and Contributors. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+/*
+ * Normal world image measuring the latency of the SMCs of the BL31 benchmark
+ * service (ENABLE_SMC_BENCH=1). Each call is followed by SMC_BENCH_GET_TS,
+ * which splits its round trip at the entry to the SMC handler of BL31, at the
+ * entry to the service handler and at the exit from EL3. The distribution of
+ * each part is kept in a histogram with one bucket per counter tick, from
+ * which the percentiles are printed.
+ */
+
+#include <smc_bench_svc.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifndef SMC_BENCH_ITERATIONS
+#define SMC_BENCH_ITERATIONS	1000000
+#endif
+
+#define PSCI_SYSTEM_OFF		U(0x84000008)
+#define SMC_OK			0
+
+/* PL011 registers */
+#define UARTDR			0x000
+#define UARTFR			0x018
+#define PL011_UARTFR_TXFF	(1U << 5)
+
+/* Latencies of HIST_BUCKETS ticks or more are counted in the last bucket */
+#define HIST_BUCKETS		4096
+
+typedef struct smc_ret {
+	uint64_t x[8];
+} smc_ret_t;
+
+typedef struct hist {
+	uint32_t bucket[HIST_BUCKETS];
+	uint64_t count;
+	uint64_t min;
+	uint64_t max;
+	uint64_t sum;
+} hist_t;
+
+/* Parts of the round trip of a benchmark call */
+enum {
+	LAT_ROUND_TRIP,		/* SMC instruction to return */
+	LAT_ENTRY,		/* SMC instruction to BL31 SMC handler */
+	LAT_DISPATCH,		/* BL31 SMC handler to service handler */
+	LAT_SERVICE,		/* Service handler to exit from EL3 */
+	LAT_RETURN,		/* Exit from EL3 to return */
+	LAT_COUNT
+};
+
+static const char *const lat_names[LAT_COUNT] = {
+	"round trip",
+	"entry",
+	"dispatch",
+	"service",
+	"return",
+};
+
+static hist_t hists[LAT_COUNT];
+static uint64_t cnt_freq;
+
+/* The compiler may emit calls to memset for the loops below */
+void *memset(void *dst, int val, size_t count)
+{
+	char *p = dst;
+
+	while (count-- != 0U)
+		*p++ = (char)val;
+
+	return dst;
+}
+
+static void uart_putc(char c)
+{
+	volatile uint32_t *fr = (volatile uint32_t *)(UART_BASE + UARTFR);
+	volatile uint32_t *dr = (volatile uint32_t *)(UART_BASE + UARTDR);
+
+	while ((*fr & PL011_UARTFR_TXFF) != 0U)
+		;
+	*dr = (uint32_t)c;
+}
+
+static void print_str(const char *s)
+{
+	while (*s != '\0') {
+		if (*s == '\n')
+			uart_putc('\r');
+		uart_putc(*s++);
+	}
+}
+
+/* Print a number right-aligned in a field of the given width */
+static void print_u64(uint64_t val, int width)
+{
+	char buf[21];
+	int i = 0;
+
+	do {
+		buf[i++] = (char)('0' + (val % 10U));
+		val /= 10U;
+	} while (val != 0U);
+
+	for (; width > i; width--)
+		uart_putc(' ');
+	while (i > 0)
+		uart_putc(buf[--i]);
+}
+
+static inline uint64_t read_cntpct(void)
+{
+	uint64_t val;
+
+	__asm__ volatile("isb\n\tmrs %0, cntpct_el0" : "=r" (val) : : "memory");
+	return val;
+}
+
+static inline uint64_t read_cntfrq(void)
+{
+	uint64_t val;
+
+	__asm__ volatile("mrs %0, cntfrq_el0" : "=r" (val));
+	return val;
+}
+
+static inline void smc(uint64_t fid, uint64_t a1, uint64_t a2, uint64_t a3,
+		       uint64_t a4, uint64_t a5, uint64_t a6, uint64_t a7,
+		       smc_ret_t *ret)
+{
+	register uint64_t x0 __asm__("x0") = fid;
+	register uint64_t x1 __asm__("x1") = a1;
+	register uint64_t x2 __asm__("x2") = a2;
+	register uint64_t x3 __asm__("x3") = a3;
+	register uint64_t x4 __asm__("x4") = a4;
+	register uint64_t x5 __asm__("x5") = a5;
+	register uint64_t x6 __asm__("x6") = a6;
+	register uint64_t x7 __asm__("x7") = a7;
+
+	__asm__ volatile("smc #0"
+			 : "+r" (x0), "+r" (x1), "+r" (x2), "+r" (x3),
+			   "+r" (x4), "+r" (x5), "+r" (x6), "+r" (x7)
+			 :
+			 : "x8", "x9", "x10", "x11", "x12", "x13", "x14",
+			   "x15", "x16", "x17", "memory");
+
+	ret->x[0] = x0;
+	ret->x[1] = x1;
+	ret->x[2] = x2;
+	ret->x[3] = x3;
+	ret->x[4] = x4;
+	ret->x[5] = x5;
+	ret->x[6] = x6;
+	ret->x[7] = x7;
+}
+
+static void hist_add(hist_t *h, uint64_t ticks)
+{
+	h->bucket[(ticks < HIST_BUCKETS) ? ticks : (HIST_BUCKETS - 1)]++;
+	if ((h->count == 0U) || (ticks < h->min))
+		h->min = ticks;
+	if (ticks > h->max)
+		h->max = ticks;
+	h->sum += ticks;
+	h->count++;
+}
+
+/* Smallest latency reached by at least per_mille/1000 of the samples */
+static uint64_t hist_percentile(const hist_t *h, unsigned int per_mille)
+{
+	uint64_t target = (h->count * per_mille + 999U) / 1000U;
+	uint64_t seen = 0U;
+	unsigned int i;
+
+	for (i = 0U; i < (HIST_BUCKETS - 1U); i++) {
+		seen += h->bucket[i];
+		if (seen >= target)
+			return i;
+	}
+
+	return h->max;
+}
+
+static uint64_t ticks_to_ns(uint64_t ticks)
+{
+	return (ticks * 1000000000U) / cnt_freq;
+}
+
+static void print_lat(const char *name, uint64_t ticks)
+{
+	print_str(name);
+	print_u64(ticks_to_ns(ticks), 8);
+}
+
+static void hist_print(const char *name, const hist_t *h)
+{
+	print_str("  ");
+	print_str(name);
+	print_str(":");
+	print_lat(" min", h->min);
+	print_lat(" avg", h->sum / h->count);
+	print_lat(" p50", hist_percentile(h, 500U));
+	print_lat(" p90", hist_percentile(h, 900U));
+	print_lat(" p99", hist_percentile(h, 990U));
+	print_lat(" p99.9", hist_percentile(h, 999U));
+	print_lat(" max", h->max);
+	print_str(" ns\n");
+}
+
+static void bench(const char *name, uint32_t fid, uint64_t arg)
+{
+	smc_ret_t ret;
+	uint64_t t0, t3, entry, handler, exit;
+	uint32_t discarded = 0U;
+	unsigned int i;
+
+	memset(hists, 0, sizeof(hists));
+
+	for (i = 0U; i < SMC_BENCH_ITERATIONS; i++) {
+		t0 = read_cntpct();
+		smc(fid, arg, 2, 3, 4, 5, 6, 7, &ret);
+		t3 = read_cntpct();
+
+		smc(SMC_BENCH_GET_TS, 0, 0, 0, 0, 0, 0, 0, &ret);
+		entry = ret.x[1];
+		handler = ret.x[2];
+		exit = ret.x[3];
+
+		/*
+		 * Drop the samples where something else went through EL3 in
+		 * between, e.g. a secure interrupt, as the exit time is then
+		 * not that of the benchmark call.
+		 */
+		if ((t0 > entry) || (entry > handler) || (handler > exit) ||
+		    (exit > t3)) {
+			discarded++;
+			continue;
+		}
+
+		hist_add(&hists[LAT_ROUND_TRIP], t3 - t0);
+		hist_add(&hists[LAT_ENTRY], entry - t0);
+		hist_add(&hists[LAT_DISPATCH], handler - entry);
+		hist_add(&hists[LAT_SERVICE], exit - handler);
+		hist_add(&hists[LAT_RETURN], t3 - exit);
+	}
+
+	print_str(name);
+	print_str(": ");
+	print_u64(hists[LAT_ROUND_TRIP].count, 0);
+	print_str(" calls, ");
+	print_u64(discarded, 0);
+	print_str(" discarded\n");
+
+	if (hists[LAT_ROUND_TRIP].count == 0U)
+		return;
+
+	for (i = 0U; i < LAT_COUNT; i++)
+		hist_print(lat_names[i], &hists[i]);
+}
+
+void smc_bench_main(void)
+{
+	smc_ret_t ret;
+	unsigned int i;
+
+	cnt_freq = read_cntfrq();
+
+	print_str("SMC benchmark, counter at ");
+	print_u64(cnt_freq, 0);
+	print_str(" Hz\n");
+
+	smc(SMC_BENCH_ECHO, 1, 2, 3, 4, 5, 6, 7, &ret);
+	for (i = 1U; i < 8U; i++) {
+		if (ret.x[i] != i)
+			break;
+	}
+	if ((ret.x[0] != SMC_OK) || (i != 8U)) {
+		print_str("SMC benchmark service not found, build BL31 with ENABLE_SMC_BENCH=1\n");
+	} else {
+		bench("null", SMC_BENCH_NULL, 0);
+		bench("echo", SMC_BENCH_ECHO, 1);
+		bench("touch", SMC_BENCH_TOUCH, SMC_BENCH_BUF_SIZE);
+	}
+
+	smc(PSCI_SYSTEM_OFF, 0, 0, 0, 0, 0, 0, 0, &ret);
+}
@@ -85,7 +85,12 @@ unsigned int uniphier_calc_core_pos(u_register_t mpidr);
 
 #define UNIPHIER_IMAGE_BUF_BASE		((UNIPHIER_BLOCK_BUF_BASE) + \
 					 (UNIPHIER_BLOCK_BUF_SIZE))
+#if IMAGE_DECOMPRESS_STREAM
+/* two input chunks and the workspace of the stream decompressor */
+#define UNIPHIER_IMAGE_BUF_SIZE		0x00040000
+#else
 #define UNIPHIER_IMAGE_BUF_SIZE		((UNIPHIER_NS_DRAM_LIMIT) - \
 					 (UNIPHIER_IMAGE_BUF_BASE))
+#endif
 
 #endif /* UNIPHIER_H */
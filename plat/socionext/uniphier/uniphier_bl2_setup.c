@@ -115,13 +115,27 @@ bl_params_t *plat_get_next_bl_params(void)
 	return get_next_bl_params_from_mem_params_desc();
 }
 
+#if defined(UNIPHIER_DECOMPRESS_GZIP) && IMAGE_DECOMPRESS_STREAM
+static const decompressor_stream_t uniphier_gunzip_stream = {
+	.init = gunzip_stream_init,
+	.feed = gunzip_stream_feed,
+	.finish = gunzip_stream_finish,
+};
+#endif
+
 void bl2_plat_preload_setup(void)
 {
 #ifdef UNIPHIER_DECOMPRESS_GZIP
+#if IMAGE_DECOMPRESS_STREAM
+	image_decompress_stream_init(UNIPHIER_IMAGE_BUF_BASE,
+				     UNIPHIER_IMAGE_BUF_SIZE,
+				     &uniphier_gunzip_stream);
+#else
 	image_decompress_init(UNIPHIER_IMAGE_BUF_BASE,
 			      UNIPHIER_IMAGE_BUF_SIZE,
 			      gunzip);
 #endif
+#endif
 }
 
 int bl2_plat_handle_pre_image_load(unsigned int image_id)
@@ -108,3 +108,12 @@ DECLARE_RT_SVC(
 		NULL,
 		arm_arch_svc_smc_handler
 );
+
+#if SMC_FAST_PATH
+/* Serve the most frequent Arm Architecture Service Calls from the fast path */
+DECLARE_RT_FAST_SMC(smccc_version, SMCCC_VERSION, arm_arch_svc_smc_handler);
+#if WORKAROUND_CVE_2017_5715
+DECLARE_RT_FAST_SMC(smccc_arch_workaround_1, SMCCC_ARCH_WORKAROUND_1,
+		    arm_arch_svc_smc_handler);
+#endif
+#endif
@@ -0,0 +1,97 @@
+/*
+ * Copyright (c) 2018, ARM Limited and Contributors. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <arch_helpers.h>
+#include <cpu_data.h>
+#include <debug.h>
+#include <platform.h>
+#include <platform_def.h>
+#include <runtime_svc.h>
+#include <smc_bench_svc.h>
+#include <smccc_helpers.h>
+#include <stddef.h>
+#include <utils_def.h>
+
+/* Timestamps of the last benchmark call on each CPU */
+typedef struct smc_bench_ts {
+	uint64_t entry;
+	uint64_t handler;
+} __aligned(CACHE_WRITEBACK_GRANULE) smc_bench_ts_t;
+
+static smc_bench_ts_t smc_bench_ts[PLATFORM_CORE_COUNT];
+
+/* Buffer written by SMC_BENCH_TOUCH, shared by all CPUs */
+static uint8_t smc_bench_buf[SMC_BENCH_BUF_SIZE]
+	__aligned(CACHE_WRITEBACK_GRANULE);
+
+static void smc_bench_touch(u_register_t size)
+{
+	size_t i;
+
+	size = MIN(size, (u_register_t)sizeof(smc_bench_buf));
+	for (i = 0U; i < size; i += CACHE_WRITEBACK_GRANULE)
+		smc_bench_buf[i]++;
+}
+
+/*
+ * Top-level benchmark service SMC handler. The time of entry is read first so
+ * that it includes as little of the service as possible.
+ */
+static uintptr_t smc_bench_smc_handler(uint32_t smc_fid,
+			     u_register_t x1,
+			     u_register_t x2,
+			     u_register_t x3,
+			     u_register_t x4,
+			     void *cookie,
+			     void *handle,
+			     u_register_t flags)
+{
+	uint64_t now = read_cntpct_el0();
+	smc_bench_ts_t *ts = &smc_bench_ts[plat_my_core_pos()];
+
+	if (smc_fid == SMC_BENCH_GET_TS) {
+		/*
+		 * The exit timestamp is that of the previous call as long as
+		 * nothing else entered EL3 on this CPU since.
+		 */
+		SMC_RET4(handle, SMC_OK, ts->entry, ts->handler,
+			get_cpu_data(cpu_data_smc_bench_ts[
+					CPU_DATA_SMC_BENCH_EXIT_IDX]));
+	}
+
+	ts->entry = get_cpu_data(cpu_data_smc_bench_ts[
+					CPU_DATA_SMC_BENCH_ENTRY_IDX]);
+	ts->handler = now;
+
+	switch (smc_fid) {
+	case SMC_BENCH_NULL:
+		SMC_RET1(handle, SMC_OK);
+
+	case SMC_BENCH_ECHO:
+		SMC_RET8(handle, SMC_OK, x1, x2, x3, x4,
+			SMC_GET_GP(handle, CTX_GPREG_X5),
+			SMC_GET_GP(handle, CTX_GPREG_X6),
+			SMC_GET_GP(handle, CTX_GPREG_X7));
+
+	case SMC_BENCH_TOUCH:
+		smc_bench_touch(x1);
+		SMC_RET1(handle, SMC_OK);
+
+	default:
+		WARN("Unimplemented SMC benchmark Call: 0x%x\n", smc_fid);
+		SMC_RET1(handle, SMC_UNK);
+	}
+}
+
+/* Register the SMC benchmark service as runtime service */
+DECLARE_RT_SVC(
+		smc_bench_svc,
+		OEN_OEM_START,
+		OEN_OEM_END,
+		SMC_TYPE_FAST,
+		NULL,
+		smc_bench_smc_handler
+);
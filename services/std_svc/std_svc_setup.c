@@ -142,6 +142,29 @@ static uintptr_t std_svc_smc_handler(uint32_t smc_fid,
 	}
 }
 
+#if SMC_FAST_PATH && !ENABLE_RUNTIME_INSTRUMENTATION
+/*
+ * PSCI_VERSION is queried often enough to be served from the fast SMC path.
+ * It still goes through the PSCI SMC handler, which checks the caller.
+ * With runtime instrumentation it is left to std_svc_smc_handler() so that
+ * the PSCI entry and exit timestamps are captured for it too.
+ */
+static uintptr_t std_svc_psci_version_handler(uint32_t smc_fid,
+			     u_register_t x1,
+			     u_register_t x2,
+			     u_register_t x3,
+			     u_register_t x4,
+			     void *cookie,
+			     void *handle,
+			     u_register_t flags)
+{
+	SMC_RET1(handle, psci_smc_handler(smc_fid, x1, x2, x3, x4,
+			cookie, handle, flags));
+}
+
+DECLARE_RT_FAST_SMC(psci_version, PSCI_VERSION, std_svc_psci_version_handler);
+#endif
+
 /* Register Standard Service Calls as runtime service */
 DECLARE_RT_SVC(
 		std_svc,